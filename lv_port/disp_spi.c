@@ -78,6 +78,12 @@
 #define SPI_TRANSACTION_POOL_RESERVE 1	/* defines minimum size */
 #endif
 
+/* Size of the constant pattern buffer used by disp_spi_send_fill(), every queued fill transaction sends this many bytes */
+#define SPI_FILL_BUFFER_SIZE 1024
+
+/* Largest DMA transaction the SPI master driver accepts when the bus was initialized with max_transfer_sz = 0 */
+#define SPI_DEFAULT_MAX_TRANSFER_SIZE 4092
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -95,6 +101,22 @@ static spi_device_handle_t spi;
 static QueueHandle_t TransactionPool = NULL;
 static transaction_cb_t chained_post_cb;
 
+/* Source of disp_spi_send_fill() transactions, allocated in DMA capable memory by the first fill so displays that
+ * never fill don't pay for it */
+static uint8_t *fill_buffer = NULL;
+static int fill_pattern = -1;
+
+/* max_transfer_sz of the bus, 0 when not known */
+static size_t max_transfer_size = 0;
+
+/* Queued transactions sent and completed, they complete in the order they were queued */
+static uint32_t trans_queued = 0;
+static volatile uint32_t trans_done = 0;
+
+/* Traffic of all transactions, see disp_spi_get_stats() */
+static disp_spi_stats_t stats;
+static disp_spi_trace_cb_t trace_cb = NULL;
+
 /**********************
  *      MACROS
  **********************/
@@ -184,6 +206,20 @@ void disp_spi_transaction(const uint8_t *data, size_t length,
         return;
     }
 
+    if (trace_cb) {
+        trace_cb(data, length, flags, addr);
+    }
+
+    stats.transactions++;
+    if (flags & DISP_SPI_RECEIVE) {
+        stats.rx_bytes += length;
+    } else {
+        stats.tx_bytes += length;
+    }
+    if (flags & (DISP_SPI_SEND_POLLING | DISP_SPI_SEND_SYNCHRONOUS)) {
+        stats.blocking++;
+    }
+
     spi_transaction_ext_t t = {0};
 
     /* transaction length is in bits */
@@ -266,10 +302,86 @@ void disp_spi_transaction(const uint8_t *data, size_t length,
         memcpy(pTransaction, &t, sizeof(t));
         if (spi_device_queue_trans(spi, (spi_transaction_t *) pTransaction, portMAX_DELAY) != ESP_OK) {
 			xQueueSend(TransactionPool, &pTransaction, portMAX_DELAY);	/* send failed transaction back to the pool to be reused */
+        } else {
+			trans_queued++;
         }
     }
 }
 
+void disp_spi_send_fill(uint8_t pattern, size_t length)
+{
+	if (fill_buffer == NULL) {
+		fill_buffer = heap_caps_malloc(SPI_FILL_BUFFER_SIZE, MALLOC_CAP_DMA);
+		if (fill_buffer == NULL) {
+			ESP_LOGE(TAG, "No memory for the fill buffer, filling %u bytes with polling transactions", length);
+
+			/* the transactions complete before returning, the stack buffer can be used */
+			uint8_t line[32];
+			memset(line, pattern, sizeof(line));
+			while (length > 0) {
+				size_t chunk = (length < sizeof(line)) ? length : sizeof(line);
+				disp_spi_transaction(line, chunk, DISP_SPI_SEND_POLLING, NULL, 0, 0);
+				length -= chunk;
+			}
+			return;
+		}
+		fill_pattern = -1;
+	}
+
+	if (fill_pattern != pattern) {
+		/* queued transactions of a previous fill could still be reading the buffer */
+		disp_wait_for_pending_transactions();
+		memset(fill_buffer, pattern, SPI_FILL_BUFFER_SIZE);
+		fill_pattern = pattern;
+	}
+
+	while (length > 0) {
+		size_t chunk = (length < SPI_FILL_BUFFER_SIZE) ? length : SPI_FILL_BUFFER_SIZE;
+		disp_spi_transaction(fill_buffer, chunk, DISP_SPI_SEND_QUEUED, NULL, 0, 0);
+		length -= chunk;
+	}
+}
+
+void disp_spi_set_max_transfer_size(size_t size)
+{
+	max_transfer_size = size;
+}
+
+size_t disp_spi_get_max_transfer_size(void)
+{
+	return (max_transfer_size > 0) ? max_transfer_size : SPI_DEFAULT_MAX_TRANSFER_SIZE;
+}
+
+uint32_t disp_spi_get_transaction_seq(void)
+{
+	return trans_queued;
+}
+
+void disp_spi_wait_for_transaction(uint32_t seq)
+{
+    spi_transaction_t *presult;
+
+	while ((int32_t) (trans_done - seq) < 0) {	/* service results until the transaction completed */
+        if (spi_device_get_trans_result(spi, &presult, 1) == ESP_OK) {
+			xQueueSend(TransactionPool, &presult, portMAX_DELAY);
+        }
+    }
+}
+
+void disp_spi_set_trace_cb(disp_spi_trace_cb_t cb)
+{
+	trace_cb = cb;
+}
+
+void disp_spi_get_stats(disp_spi_stats_t *stats_out)
+{
+	*stats_out = stats;
+}
+
+void disp_spi_reset_stats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
 
 void disp_wait_for_pending_transactions(void)
 {
@@ -301,6 +413,10 @@ static void IRAM_ATTR spi_ready(spi_transaction_t *trans)
 {
     disp_spi_send_flag_t flags = (disp_spi_send_flag_t) trans->user;
 
+    if (!(flags & (DISP_SPI_SEND_POLLING | DISP_SPI_SEND_SYNCHRONOUS))) {
+        trans_done++;
+    }
+
     if (flags & DISP_SPI_SIGNAL_FLUSH) {
         lv_disp_t * disp = NULL;
 
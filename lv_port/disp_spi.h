@@ -42,6 +42,17 @@ typedef enum _disp_spi_send_flag_t {
 	DISP_SPI_VARIABLE_DUMMY		= 0x00002000,
 } disp_spi_send_flag_t;
 
+/* Called with every transaction before it is sent, from the task sending it */
+typedef void (*disp_spi_trace_cb_t)(const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint64_t addr);
+
+typedef struct {
+    uint32_t transactions;      /* Transactions sent */
+    uint32_t blocking;          /* Polling and synchronous transactions, each waits for the queue to drain */
+    uint64_t tx_bytes;          /* Bytes sent, without command and address */
+    uint64_t rx_bytes;          /* Bytes received */
+} disp_spi_stats_t;
+
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -60,6 +71,33 @@ void disp_spi_remove_device();
 void disp_spi_transaction(const uint8_t *data, size_t length,
     disp_spi_send_flag_t flags, uint8_t *out, uint64_t addr, uint8_t dummy_bits);
 
+/*	Send length bytes of the same pattern (e.g. to clear the display RAM).
+	The bytes come from an internal DMA capable buffer in large queued transactions,
+	so the caller doesn't need to provide a buffer of the full length. The buffer is
+	allocated by the first call.
+*/
+void disp_spi_send_fill(uint8_t pattern, size_t length);
+
+/*	Largest transaction the bus accepts, set by whoever initializes the bus with its max_transfer_sz.
+	Drivers sending more than that in one go have to split it into chunks of at most this size.
+*/
+void disp_spi_set_max_transfer_size(size_t size);
+size_t disp_spi_get_max_transfer_size(void);
+
+/*	Queued transactions are numbered in the order they are sent. A driver that reuses a buffer it handed
+	to a queued transaction can wait for just that transaction to complete instead of all pending ones.
+*/
+uint32_t disp_spi_get_transaction_seq(void);	/* number of the last queued transaction */
+void disp_spi_wait_for_transaction(uint32_t seq);
+
+/*	Traffic counters and trace, to profile what a driver sends per frame or to replay the transactions
+	into a model of the display controller. Received data is not traced, it is not known yet when the
+	callback runs. Pass NULL to stop tracing.
+*/
+void disp_spi_set_trace_cb(disp_spi_trace_cb_t cb);
+void disp_spi_get_stats(disp_spi_stats_t *stats);
+void disp_spi_reset_stats(void);
+
 void disp_wait_for_pending_transactions(void);
 void disp_spi_acquire(void);
 void disp_spi_release(void);
@@ -21,6 +21,8 @@
 
 #include "lvgl_i2c/i2c_manager.h"
 
+#include "lvgl_tft/epd_greyscale.h"
+
 #ifdef LV_LVGL_H_INCLUDE_SIMPLE
 #include "lvgl.h"
 #else
@@ -54,7 +56,7 @@ static int calculate_spi_max_transfer_size(const int display_buffer_size);
 /**
  * Handle FT81X initialization as it's a particular case
  */
-static void init_ft81x(int dma_channel);
+static void init_ft81x(size_t display_buffer_size, int dma_channel);
 #endif
 
 static lv_coord_t get_display_hor_res(lv_disp_drv_t *drv);
@@ -91,7 +93,7 @@ void lvgl_interface_init(lv_disp_drv_t *drv)
 #endif
 
 #if defined(CONFIG_LV_TFT_DISPLAY_CONTROLLER_FT81X)
-    init_ft81x(dma_channel);
+    init_ft81x(display_buffer_size, dma_channel);
     return;
 #endif
 
@@ -110,6 +112,7 @@ void lvgl_interface_init(lv_disp_drv_t *drv)
     lvgl_spi_driver_init(TFT_SPI_HOST, miso, DISP_SPI_MOSI, DISP_SPI_CLK,
                          spi_max_transfer_size, dma_channel, DISP_SPI_IO2, DISP_SPI_IO3);
 
+    disp_spi_set_max_transfer_size(spi_max_transfer_size);
     disp_spi_add_device(TFT_SPI_HOST);
 
     /* Add device for touch driver */
@@ -233,11 +236,11 @@ size_t lvgl_get_display_buffer_size(lv_disp_drv_t *drv)
     disp_buffer_size = get_display_hor_res(drv) * get_display_ver_res(drv));
 #endif
 #elif defined(CONFIG_LV_TFT_DISPLAY_CONTROLLER_IL3820)
-    disp_buffer_size = get_display_ver_res(drv) * IL3820_COLUMNS;
+    disp_buffer_size = get_display_ver_res(drv) * IL3820_COLUMNS * EPD_BITS_PER_PIXEL;
 #elif defined(CONFIG_LV_TFT_DISPLAY_CONTROLLER_JD79653A)
-    disp_buffer_size = ((get_display_ver_res(drv) * get_display_ver_res(drv)) / 8); // 5KB
+    disp_buffer_size = ((get_display_ver_res(drv) * get_display_ver_res(drv)) / 8) * EPD_BITS_PER_PIXEL; // 5KB
 #elif defined(CONFIG_LV_TFT_DISPLAY_CONTROLLER_UC8151D)
-    disp_buffer_size = ((get_display_ver_res(drv) * get_display_ver_res(drv)) / 8); // 2888 bytes
+    disp_buffer_size = ((get_display_ver_res(drv) * get_display_ver_res(drv)) / 8) * EPD_BITS_PER_PIXEL; // 2888 bytes
 #elif defined(CONFIG_LV_TFT_DISPLAY_CONTROLLER_PCD8544)
     disp_buffer_size = (get_display_hor_res(drv) * (get_display_ver_res(drv) / 8));
 #else
@@ -323,14 +326,14 @@ static int calculate_spi_max_transfer_size(const int display_buffer_size)
 }
 
 #if defined(CONFIG_LV_TFT_DISPLAY_CONTROLLER_FT81X)
-static void init_ft81x(int dma_channel)
+static void init_ft81x(size_t display_buffer_size, int dma_channel)
 {
-    size_t display_buffer_size = lvgl_get_display_buffer_size();
     int spi_max_transfer_size = calculate_spi_max_transfer_size(display_buffer_size);
 
     lvgl_spi_driver_init(TFT_SPI_HOST, DISP_SPI_MISO, DISP_SPI_MOSI, DISP_SPI_CLK,
                          spi_max_transfer_size, dma_channel, DISP_SPI_IO2, DISP_SPI_IO3);
 
+    disp_spi_set_max_transfer_size(spi_max_transfer_size);
     disp_spi_add_device(TFT_SPI_HOST);
 
 #if defined(CONFIG_LV_TOUCH_CONTROLLER_FT81X)
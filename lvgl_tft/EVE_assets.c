@@ -0,0 +1,326 @@
+/*
+@file    EVE_assets.c
+@brief   RAM_G cache for images and fonts uploaded to EVE once and referenced from display lists
+@version 4.1 LvGL edition
+
+@section info
+
+Assets are placed first-fit in the RAM_G range given to EVE_assets_init(), when one doesn't fit the least recently
+used assets that are not locked are dropped until it does. Looking an asset up counts as using it.
+
+Uploads wait for the co-processor to finish, as the asset is expected to be used right away and this only happens
+once per asset. All functions send SPI commands, so they have to be called from the task flushing LvGL.
+*/
+
+#include "EVE_assets.h"
+#include "EVE_commands.h"
+
+typedef struct {
+	uint32_t id;
+	uint32_t addr;
+	uint32_t size;
+	uint32_t last_use;
+	uint8_t locks;
+	uint8_t used;
+} EVE_asset;
+
+static EVE_asset assets[EVE_ASSETS_MAX];
+static uint32_t assets_base = 0;
+static uint32_t assets_end = 0;
+static uint32_t use_count = 0;
+
+
+static EVE_asset *asset_get(uint32_t id)
+{
+	for(uint8_t i = 0; i < EVE_ASSETS_MAX; i++)
+	{
+		if(assets[i].used && (assets[i].id == id))
+		{
+			return &assets[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+/* check if [addr, addr + size) is clear of all assets */
+static bool range_free(uint32_t addr, uint32_t size)
+{
+	for(uint8_t i = 0; i < EVE_ASSETS_MAX; i++)
+	{
+		if(assets[i].used && (addr < (assets[i].addr + assets[i].size)) && (assets[i].addr < (addr + size)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/* lowest address with room for size bytes, the gaps start either at the base or right after an asset */
+static uint32_t find_space(uint32_t size)
+{
+	uint32_t best = EVE_ASSET_NONE;
+
+	if(((assets_base + size) <= assets_end) && range_free(assets_base, size))
+	{
+		return assets_base;
+	}
+
+	for(uint8_t i = 0; i < EVE_ASSETS_MAX; i++)
+	{
+		if(!assets[i].used)
+		{
+			continue;
+		}
+
+		uint32_t addr = assets[i].addr + assets[i].size;
+
+		if((addr < best) && ((addr + size) <= assets_end) && range_free(addr, size))
+		{
+			best = addr;
+		}
+	}
+
+	return best;
+}
+
+
+static EVE_asset *evict_lru(void)
+{
+	EVE_asset *lru = NULL;
+
+	for(uint8_t i = 0; i < EVE_ASSETS_MAX; i++)
+	{
+		if(assets[i].used && (assets[i].locks == 0) && ((lru == NULL) || (assets[i].last_use < lru->last_use)))
+		{
+			lru = &assets[i];
+		}
+	}
+
+	if(lru != NULL)
+	{
+		lru->used = 0;
+	}
+
+	return lru;
+}
+
+
+/* find a free slot and RAM_G space for a new asset, evicting as needed */
+static EVE_asset *asset_alloc(uint32_t id, uint32_t size)
+{
+	EVE_asset *slot = NULL;
+	uint32_t addr;
+
+	size = (size + 3) & ~3UL;	// keep the assets DWORD aligned
+
+	if(size > (assets_end - assets_base))
+	{
+		return NULL;
+	}
+
+	for(uint8_t i = 0; i < EVE_ASSETS_MAX; i++)
+	{
+		if(!assets[i].used)
+		{
+			slot = &assets[i];
+			break;
+		}
+	}
+
+	if((slot == NULL) && ((slot = evict_lru()) == NULL))
+	{
+		return NULL;
+	}
+
+	while((addr = find_space(size)) == EVE_ASSET_NONE)
+	{
+		if(evict_lru() == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	slot->id = id;
+	slot->addr = addr;
+	slot->size = size;
+	slot->last_use = ++use_count;
+	slot->locks = 0;
+	slot->used = 1;
+
+	return slot;
+}
+
+
+void EVE_assets_init(uint32_t base, uint32_t size)
+{
+	for(uint8_t i = 0; i < EVE_ASSETS_MAX; i++)
+	{
+		assets[i].used = 0;
+	}
+
+	assets_base = base;
+	assets_end = base + size;
+}
+
+
+uint32_t EVE_asset_find(uint32_t id)
+{
+	EVE_asset *asset = asset_get(id);
+
+	if(asset == NULL)
+	{
+		return EVE_ASSET_NONE;
+	}
+
+	asset->last_use = ++use_count;
+	return asset->addr;
+}
+
+
+uint32_t EVE_asset_load(uint32_t id, uint8_t type, const uint8_t *data, uint32_t len, uint32_t size)
+{
+	uint32_t addr = EVE_asset_find(id);
+
+	if(addr != EVE_ASSET_NONE)
+	{
+		return addr;
+	}
+
+	if((type == EVE_ASSET_RAW) && (len > size))
+	{
+		return EVE_ASSET_NONE;
+	}
+
+	if((type != EVE_ASSET_RAW) && (len > 0xffff))	// CMD_INFLATE and CMD_LOADIMAGE take a 16 bit length
+	{
+		return EVE_ASSET_NONE;
+	}
+
+#if !FT81X_FULL
+	if(type == EVE_ASSET_IMAGE)
+	{
+		return EVE_ASSET_NONE;
+	}
+#else
+	// the PNG decoder would overwrite the assets in its scratch area, cached and locked ones alike
+	if((type == EVE_ASSET_IMAGE) && (len >= 4) && (data[0] == 0x89) && (data[1] == 'P') && (data[2] == 'N') && (data[3] == 'G') &&
+		(assets_end > (EVE_RAM_G_SIZE - EVE_LOADIMAGE_SCRATCH)))
+	{
+		return EVE_ASSET_NONE;
+	}
+#endif
+
+	EVE_asset *asset = asset_alloc(id, size);
+	if(asset == NULL)
+	{
+		return EVE_ASSET_NONE;
+	}
+
+	switch(type)
+	{
+		case EVE_ASSET_DEFLATE:
+			EVE_cmd_inflate(asset->addr, data, len);
+			break;
+
+#if FT81X_FULL
+		case EVE_ASSET_IMAGE:
+			EVE_cmd_loadimage(asset->addr, EVE_OPT_NODL, data, len);
+			break;
+#endif
+
+		default:
+			EVE_cmd_memwrite(asset->addr, len, data);
+			break;
+	}
+
+	EVE_cmd_execute();
+
+	return asset->addr;
+}
+
+
+#if FT81X_FULL && defined (BT81X_ENABLE)
+uint32_t EVE_asset_load_flash(uint32_t id, uint32_t src, uint32_t size)
+{
+	uint32_t addr = EVE_asset_find(id);
+
+	if(addr != EVE_ASSET_NONE)
+	{
+		return addr;
+	}
+
+	EVE_asset *asset = asset_alloc(id, size);
+	if(asset == NULL)
+	{
+		return EVE_ASSET_NONE;
+	}
+
+	EVE_cmd_flashread(asset->addr, src, size);
+	EVE_cmd_execute();
+
+	return asset->addr;
+}
+#endif
+
+
+uint32_t EVE_asset_reserve(uint32_t id, uint32_t size)
+{
+	EVE_asset *asset = asset_get(id);
+
+	if(asset != NULL)
+	{
+		if(asset->size >= size)
+		{
+			asset->last_use = ++use_count;
+			return asset->addr;
+		}
+
+		if(asset->locks > 0)
+		{
+			return EVE_ASSET_NONE;
+		}
+
+		asset->used = 0;
+	}
+
+	asset = asset_alloc(id, size);
+
+	return (asset != NULL) ? asset->addr : EVE_ASSET_NONE;
+}
+
+
+void EVE_asset_lock(uint32_t id)
+{
+	EVE_asset *asset = asset_get(id);
+
+	if(asset != NULL)
+	{
+		asset->locks++;
+	}
+}
+
+
+void EVE_asset_unlock(uint32_t id)
+{
+	EVE_asset *asset = asset_get(id);
+
+	if((asset != NULL) && (asset->locks > 0))
+	{
+		asset->locks--;
+	}
+}
+
+
+void EVE_asset_evict(uint32_t id)
+{
+	EVE_asset *asset = asset_get(id);
+
+	if((asset != NULL) && (asset->locks == 0))
+	{
+		asset->used = 0;
+	}
+}
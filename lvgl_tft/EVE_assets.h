@@ -0,0 +1,53 @@
+/*
+@file    EVE_assets.h
+@brief   RAM_G cache for images and fonts uploaded to EVE once and referenced from display lists
+@version 4.1 LvGL edition
+*/
+
+#ifndef EVE_ASSETS_H_
+#define EVE_ASSETS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "EVE.h"
+
+#define EVE_ASSETS_MAX		32			// assets tracked at a time
+#define EVE_ASSET_NONE		0xffffffffUL	// not a valid asset address
+
+/* how the data of an asset is uploaded */
+#define EVE_ASSET_RAW		0	// copied as is
+#define EVE_ASSET_DEFLATE	1	// zlib stream, inflated by the co-processor
+#define EVE_ASSET_IMAGE		2	// PNG or JPEG, decoded by the co-processor, requires FT81X_FULL
+
+#define EVE_LOADIMAGE_SCRATCH	(42UL * 1024UL)	// top of RAM_G the PNG decoder of CMD_LOADIMAGE works in
+
+/* Set the range of RAM_G the assets are placed in, this drops all assets. */
+/* PNG images are only loaded if the range is clear of the EVE_LOADIMAGE_SCRATCH bytes at the end of RAM_G. */
+void EVE_assets_init(uint32_t base, uint32_t size);
+
+/* Get the RAM_G address of an asset, EVE_ASSET_NONE if it is not loaded. */
+uint32_t EVE_asset_find(uint32_t id);
+
+/* Upload an asset unless it is loaded already, evicting the least recently used unlocked assets to make room. */
+/* len is the length of the data, size the RAM_G space the asset takes once uploaded (decoded or inflated). */
+/* Returns the RAM_G address of the asset, or EVE_ASSET_NONE if it does not fit. */
+uint32_t EVE_asset_load(uint32_t id, uint8_t type, const uint8_t *data, uint32_t len, uint32_t size);
+
+#if FT81X_FULL && defined (BT81X_ENABLE)
+/* Same as EVE_asset_load() but copied from the flash attached to the BT81x, src and size must be 4 byte aligned. */
+uint32_t EVE_asset_load_flash(uint32_t id, uint32_t src, uint32_t size);
+#endif
+
+/* Make room for an asset the caller fills in, keeping it if it is loaded already and at least size bytes large. */
+/* Returns the RAM_G address of the asset, or EVE_ASSET_NONE if it does not fit or is locked with less space. */
+uint32_t EVE_asset_reserve(uint32_t id, uint32_t size);
+
+/* Locked assets are in use by a display list and are not evicted, locks nest. */
+void EVE_asset_lock(uint32_t id);
+void EVE_asset_unlock(uint32_t id);
+
+/* Drop an asset, unless it is locked. */
+void EVE_asset_evict(uint32_t id);
+
+#endif /* EVE_ASSETS_H_ */
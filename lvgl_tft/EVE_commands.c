@@ -52,6 +52,7 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "soc/soc_memory_layout.h"
@@ -69,6 +70,14 @@ typedef struct _spi_read_data {
     } __attribute__((packed));
 } spi_read_data __attribute__((aligned(4)));
 
+/* data structure for reading a block of registers or memory in one transaction */
+typedef struct _spi_read_block {
+#if defined(DISP_SPI_FULL_DUPLEX)
+    uint8_t _dummy_byte;
+#endif
+    uint8_t bytes[EVE_READ_BLOCK_MAX];
+} spi_read_block __attribute__((aligned(4)));
+
 
 /* Receive data helpers */
 #define member_size(type, member)	sizeof(((type *)0)->member)
@@ -89,11 +98,15 @@ typedef struct _spi_read_data {
 #define MEM_WRITE_24 	0x800000	// EVE Host Memory Write (24-bit format)
 
 volatile uint16_t cmdOffset = 0x0000; /* offset for the 4k co-processor FIFO */
+uint16_t cmdRead = 0x0000; /* last REG_CMD_READ seen, the co-processor only moves it forward so the free space derived from it is a lower bound */
 
 volatile uint8_t cmd_burst = 0; /* flag to indicate cmd-burst is active */
 
-// Buffer for SPI transactions
-uint8_t SPIBuffer[SPI_BUFFER_SIZE];				// must be in DMA capable memory if DMA is used!
+// Buffers for SPI transactions, used in turn so the next command can be built while the previous ones are still sent
+static uint8_t SPIBuffers[EVE_SPI_BUFFERS][SPI_BUFFER_SIZE];	// must be in DMA capable memory if DMA is used!
+static uint32_t SPIBufferSeq[EVE_SPI_BUFFERS];	// transaction that last sent each buffer
+static uint8_t SPIBufferCurrent = 0;
+uint8_t *SPIBuffer = SPIBuffers[0];
 uint16_t SPIBufferIndex = 0;
 disp_spi_send_flag_t SPIInherentSendFlags = 0;	// additional inherent SPI flags (for DIO/QIO mode switching)
 uint8_t SPIDummyReadBits = 0;					// Dummy bits for reading in DIO/QIO modes
@@ -125,13 +138,120 @@ uint8_t SPIDummyReadBits = 0;					// Dummy bits for reading in DIO/QIO modes
 // Send buffer
 #define SEND_SPI_BUFFER() \
 	disp_spi_transaction(SPIBuffer, SPIBufferIndex, (disp_spi_send_flag_t)(DISP_SPI_SEND_QUEUED | SPIInherentSendFlags), NULL, 0, 0); \
-	SPIBufferIndex = 0;
+	EVE_next_spi_buffer();
 
 // Wait for DMA queued SPI transactions to complete
 #define WAIT_SPI() \
 	disp_wait_for_pending_transactions();
 
 
+/* switch to the next SPI buffer, it is only waited for if the transaction that last sent it is still pending */
+static void EVE_next_spi_buffer(void)
+{
+	SPIBufferSeq[SPIBufferCurrent] = disp_spi_get_transaction_seq();
+
+	SPIBufferCurrent = (SPIBufferCurrent + 1) % EVE_SPI_BUFFERS;
+	SPIBuffer = SPIBuffers[SPIBufferCurrent];
+	SPIBufferIndex = 0;
+
+	disp_spi_wait_for_transaction(SPIBufferSeq[SPIBufferCurrent]);
+}
+
+
+#if EVE_USE_INT
+static SemaphoreHandle_t EVE_int_sem = NULL;	// given by the INT pin ISR
+static volatile bool EVE_int_fired = false;		// set by the INT pin ISR, REG_INT_FLAGS has news
+static uint8_t EVE_int_flags = 0;				// REG_INT_FLAGS clears on read, flags read but not handled yet
+static uint8_t EVE_int_mask = 0;				// interrupts routed to INT besides "command FIFO empty" while waiting for it
+
+static void IRAM_ATTR EVE_int_isr(void *arg)
+{
+	BaseType_t woken = pdFALSE;
+
+	EVE_int_fired = true;
+	xSemaphoreGiveFromISR(EVE_int_sem, &woken);
+	if(woken)
+	{
+		portYIELD_FROM_ISR();
+	}
+}
+
+
+/* set up the INT pin so waiting for the co-processor doesn't poll the SPI, the "command FIFO empty" interrupt */
+/* is only routed to it while waiting since it is pending most of the time and would hold INT low for all others */
+static void EVE_int_init(void)
+{
+	EVE_int_sem = xSemaphoreCreateBinary();
+	if(EVE_int_sem == NULL)
+	{
+		LV_LOG_WARN("Failed to create the INT semaphore, polling the co-processor instead");
+		return;
+	}
+
+	gpio_config_t io_conf = {
+		.pin_bit_mask = (1ULL << EVE_INT),
+		.mode = GPIO_MODE_INPUT,
+		.pull_up_en = GPIO_PULLUP_ENABLE,
+		.intr_type = GPIO_INTR_NEGEDGE,		/* INT is open drain, active low */
+	};
+	gpio_config(&io_conf);
+
+	/* the ISR service may have been installed already by another driver */
+	esp_err_t err = gpio_install_isr_service(0);
+	if(err == ESP_OK || err == ESP_ERR_INVALID_STATE)
+	{
+		err = gpio_isr_handler_add(EVE_INT, EVE_int_isr, NULL);
+	}
+
+	if(err != ESP_OK)
+	{
+		LV_LOG_WARN("Failed to install the INT pin handler, polling the co-processor instead");
+		vSemaphoreDelete(EVE_int_sem);
+		EVE_int_sem = NULL;
+		return;
+	}
+
+	EVE_memWrite8(REG_INT_MASK, EVE_int_mask);
+	EVE_int_flags = EVE_memRead8(REG_INT_FLAGS);	/* clear what happened before */
+	EVE_memWrite8(REG_INT_EN, 1);
+}
+
+
+/* route more interrupts to the INT pin, returns false if INT is not in use */
+bool EVE_int_enable(uint8_t mask)
+{
+	if(EVE_int_sem == NULL)
+	{
+		return false;
+	}
+
+	EVE_int_mask |= mask;
+	EVE_int_flags &= ~mask;	/* only report what happens from now on */
+	EVE_memWrite8(REG_INT_MASK, EVE_int_mask);
+
+	return true;
+}
+
+
+/* get and clear the flags in mask set since the last call, REG_INT_FLAGS is only read if the INT pin fired */
+uint8_t EVE_int_take_flags(uint8_t mask)
+{
+	uint8_t flags;
+
+	if(EVE_int_fired)
+	{
+		EVE_int_fired = false;	/* before the read, an interrupt after it fires again */
+		EVE_int_flags |= EVE_memRead8(REG_INT_FLAGS);
+	}
+
+	flags = EVE_int_flags & mask;
+	EVE_int_flags &= ~mask;
+
+	return flags;
+}
+#endif
+
+
 
 void DELAY_MS(uint16_t ms)
 {
@@ -241,6 +361,41 @@ uint32_t EVE_memRead32(uint32_t ftAddress)
 }
 
 
+/* read len bytes starting at ftAddress, in one transaction per EVE_READ_BLOCK_MAX bytes */
+/* reading a range of registers like this costs about as much as reading a single one */
+void EVE_memRead_block(uint32_t ftAddress, uint8_t *data, uint32_t len)
+{
+#if defined(DISP_SPI_HALF_DUPLEX)
+	// There are esp32 issues when reading in DMA half-duplex mode that prevents reading more than 1 byte at a time so we work around that
+	for(uint32_t i = 0; i < len; i++)
+	{
+		data[i] = EVE_memRead8(ftAddress + i);
+	}
+	return;
+#endif
+
+	spi_read_block block;
+	disp_spi_send_flag_t readflags = (disp_spi_send_flag_t)(DISP_SPI_RECEIVE | DISP_SPI_SEND_POLLING | DISP_SPI_ADDRESS_24 | SPIInherentSendFlags);
+
+#if defined(DISP_SPI_HALF_DUPLEX)
+	// in half-duplex mode the FT81x requires dummy bits
+	readflags |= DISP_SPI_VARIABLE_DUMMY;
+#endif
+
+	while(len > 0)
+	{
+		uint32_t block_len = (len > EVE_READ_BLOCK_MAX) ? EVE_READ_BLOCK_MAX : len;
+
+		disp_spi_transaction(NULL, SPI_READ_DUMMY_LEN + block_len, readflags, (uint8_t*)&block, ftAddress, SPIDummyReadBits);
+		memcpy(data, block.bytes, block_len);
+
+		ftAddress += block_len;
+		data += block_len;
+		len -= block_len;
+	}
+}
+
+
 void EVE_memWrite8(uint32_t ftAddress, uint8_t ftData8)
 {
 	disp_spi_transaction(&ftData8, sizeof(ftData8), (disp_spi_send_flag_t)(DISP_SPI_SEND_POLLING | DISP_SPI_ADDRESS_24 | SPIInherentSendFlags), NULL, (ftAddress | MEM_WRITE_24), 0);
@@ -263,17 +418,14 @@ void EVE_memWrite32(uint32_t ftAddress, uint32_t ftData32)
 // Note: data should be in DMA-capable memory!
 void EVE_memWrite_buffer(uint32_t ftAddress, const uint8_t *data, uint32_t len, bool LvGL_Flush)
 {
-	// chunk by DMA transfer size (SPI_TRANSER_SIZE)
+	// chunk by the largest transaction the SPI bus was set up for, DWORD aligned so the DMA reads whole words,
+	// the chunks are all queued so they follow each other without the CPU in between
+	uint32_t max_block_len = disp_spi_get_max_transfer_size() & ~3u;
+
 	uint32_t bytes_left = len;
 	while(bytes_left > 0)
 	{
-        uint32_t block_len = 0;
-        
-#if defined (SPI_TRANSFER_SIZE)
-		block_len = (bytes_left > SPI_TRANSER_SIZE ? SPI_TRANSER_SIZE : bytes_left);
-#else
-        /* ToDo Update SPI_TRANSFER_SIZE calculation, it's based on the DISP_BUF_SIZE */
-#endif
+		uint32_t block_len = (bytes_left > max_block_len ? max_block_len : bytes_left);
 
 		// only send flush on last chunk
 		disp_spi_send_flag_t flush_flag = 0;
@@ -315,6 +467,7 @@ uint8_t EVE_busy(void)
 		EVE_memWrite16(REG_CMD_WRITE, 0); /* set REG_CMD_WRITE to 0 */
 		EVE_memWrite32(REG_CMD_DL, 0);    /* reset REG_CMD_DL to 0 as required by the BT81x programming guide, should not hurt FT8xx */
 		cmdOffset = 0;
+		cmdBufferRead = 0;
 		EVE_memWrite8(REG_CPURESET, 0);  /* set REG_CMD_WRITE to 0 to restart the co-processor engine*/
 
 		#if defined (BT81X_ENABLE)
@@ -348,6 +501,8 @@ uint8_t EVE_busy(void)
 		#endif
 	}
 
+	cmdRead = cmdBufferRead;
+
 	if(cmdOffset != cmdBufferRead)
 	{
 		return 1;
@@ -361,7 +516,92 @@ uint8_t EVE_busy(void)
 
 void EVE_get_cmdoffset(void)
 {
-	cmdOffset = EVE_memRead16(REG_CMD_WRITE);
+	uint32_t regs[2];	/* REG_CMD_READ and REG_CMD_WRITE follow each other */
+
+	EVE_memRead_block(REG_CMD_READ, (uint8_t*)regs, sizeof(regs));
+	cmdRead = regs[0];
+	cmdOffset = regs[1];
+}
+
+
+/* Free space in the co-processor FIFO in bytes, from the last read pointer seen, no SPI traffic */
+/* Commands are written through the RAM_CMD address window, REG_CMDB_SPACE only tracks writes to REG_CMDB_WRITE, */
+/* so the space is derived from REG_CMD_READ, one slot is kept free to tell a full FIFO from an empty one. */
+uint16_t EVE_cmd_space(void)
+{
+	return (EVE_CMDFIFO_SIZE - 4) - ((cmdOffset - cmdRead) & (EVE_CMDFIFO_SIZE - 1));
+}
+
+
+/* Wait for the co-processor to free up space bytes in its FIFO, EVE_CMDFIFO_SIZE - 4 waits for it to go idle. */
+/* Polls REG_CMD_READ a few times since short command lists finish in microseconds, then sleeps on the INT pin */
+/* when one is configured, or backs off a tick at a time otherwise, to leave the CPU to LVGL rendering. */
+static void EVE_cmd_wait(uint16_t space)
+{
+#if EVE_USE_INT
+	bool armed = false;
+#endif
+
+	for(uint32_t polls = 0; ; polls++)
+	{
+		EVE_busy();	/* refreshes cmdRead and recovers from co-processor faults */
+		if(EVE_cmd_space() >= space)
+		{
+			break;
+		}
+
+		if(polls < EVE_CMDFIFO_WAIT_POLLS)
+		{
+			continue;
+		}
+
+#if EVE_USE_INT
+		if(EVE_int_sem != NULL)
+		{
+			if(!armed)
+			{
+				EVE_memWrite8(REG_INT_MASK, EVE_int_mask | EVE_INT_CMDEMPTY);
+				armed = true;
+			}
+
+			/* reading the flags releases the INT line, check again before sleeping in case the FIFO ran empty in between */
+			EVE_int_fired = false;
+			EVE_int_flags |= EVE_memRead8(REG_INT_FLAGS);
+			EVE_busy();
+			if(EVE_cmd_space() >= space)
+			{
+				break;
+			}
+
+			/* "FIFO empty" is the only interrupt, time out to also catch space freed up before that */
+			xSemaphoreTake(EVE_int_sem, 1);
+			continue;
+		}
+#endif
+
+		vTaskDelay(1);
+	}
+
+#if EVE_USE_INT
+	if(armed)
+	{
+		EVE_memWrite8(REG_INT_MASK, EVE_int_mask);
+	}
+#endif
+}
+
+
+/* Make sure the FIFO has room for space more bytes, starting the co-processor on what was written so far if not */
+/* Must not be called while a cmd-burst is buffering. */
+void EVE_cmd_wait_space(uint16_t space)
+{
+	if(EVE_cmd_space() >= space)
+	{
+		return;
+	}
+
+	EVE_cmd_start();	/* the co-processor only frees up what it was told to execute */
+	EVE_cmd_wait(space);
 }
 
 
@@ -385,13 +625,15 @@ void EVE_cmd_start(void)
 void EVE_cmd_execute(void)
 {
 	EVE_cmd_start();
-	while (EVE_busy());
+	EVE_cmd_wait(EVE_CMDFIFO_SIZE - 4);
 }
 
 
 /* begin a co-processor command, this is used for all non-display-list commands */
 void EVE_begin_cmd(uint32_t command)
 {
+	EVE_cmd_wait_space(SPI_BUFFER_SIZE);
+
 	BUFFER_SPI_WRITE_ADDRESS(EVE_RAM_CMD + cmdOffset)
 	BUFFER_SPI_DWORD(command)
 
@@ -488,6 +730,8 @@ void eve_spi_CMD_write(uint64_t addr, const uint8_t *data, uint16_t len)
 }
 
 
+/* Stream data into the co-processor FIFO behind the command using it, each block is started as soon as it is written */
+/* and the next one only waits for the room it needs, so the transfer overlaps with the co-processor working on it. */
 void block_transfer(const uint8_t *data, uint32_t len)
 {
 	WAIT_SPI();		// SPI commands must be in CMD buffer first
@@ -500,18 +744,26 @@ void block_transfer(const uint8_t *data, uint32_t len)
 		uint32_t block_len;
 		block_len = (bytes_left > BLOCK_TRANSFER_SIZE ? BLOCK_TRANSFER_SIZE : bytes_left);
 
+		// don't write past the end of RAM_CMD, the rest of the block goes to its start
+		// (cmdOffset is DWORD aligned so only the last block of the data gets padded)
+		if(block_len > (EVE_CMDFIFO_SIZE - cmdOffset))
+		{
+			block_len = EVE_CMDFIFO_SIZE - cmdOffset;
+		}
+
+		EVE_cmd_wait_space((block_len + 3) & ~3);
+
 		eve_spi_CMD_write(EVE_RAM_CMD + cmdOffset, data, block_len);
 
 		data += block_len;
 		bytes_left -= block_len;
 
-		// signal to process data
-		EVE_cmd_execute();
+		// signal to process data, without waiting for it
+		EVE_cmd_start();
 	}
 }
 
-#if FT81X_FULL
-/* this is meant to be called outside display-list building, it includes executing the command and waiting for completion, does not support cmd-burst */
+/* this is meant to be called outside display-list building, it starts executing the command, use EVE_cmd_execute() to wait for completion, does not support cmd-burst */
 void EVE_cmd_inflate(uint32_t ptr, const uint8_t *data, uint16_t len)
 {
 	EVE_begin_cmd(CMD_INFLATE);
@@ -525,8 +777,38 @@ void EVE_cmd_inflate(uint32_t ptr, const uint8_t *data, uint16_t len)
 }
 
 
+#if defined (FT81X_ENABLE)
+/* this is meant to be called outside display-list building, does not support cmd-burst */
+void EVE_cmd_mediafifo(uint32_t ptr, uint32_t size)
+{
+	EVE_begin_cmd(CMD_MEDIAFIFO);
+	BUFFER_SPI_DWORD(ptr)
+	BUFFER_SPI_DWORD(size)
+
+	EVE_inc_cmdoffset(8);
+
+	SEND_SPI_BUFFER()
+}
+
+
+/* this is meant to be called outside display-list building, it starts executing the command, does not support cmd-burst */
+/* with EVE_OPT_MEDIAFIFO the video is read from the media FIFO, otherwise it has to follow in the command FIFO */
+void EVE_cmd_playvideo(uint32_t options)
+{
+	EVE_begin_cmd(CMD_PLAYVIDEO);
+	BUFFER_SPI_DWORD(options)
+
+	EVE_inc_cmdoffset(4);
+
+	SEND_SPI_BUFFER()
+}
+#endif
+
+
+#if FT81X_FULL
+
 #if defined (BT81X_ENABLE)
-/* this is meant to be called outside display-list building, it includes executing the command and waiting for completion, does not support cmd-burst */
+/* this is meant to be called outside display-list building, it starts executing the command, use EVE_cmd_execute() to wait for completion, does not support cmd-burst */
 void EVE_cmd_inflate2(uint32_t ptr, uint32_t options, const uint8_t *data, uint16_t len)
 {
 	EVE_begin_cmd(CMD_INFLATE2);
@@ -545,7 +827,7 @@ void EVE_cmd_inflate2(uint32_t ptr, uint32_t options, const uint8_t *data, uint1
 #endif
 
 
-/* this is meant to be called outside display-list building, it includes executing the command and waiting for completion, does not support cmd-burst */
+/* this is meant to be called outside display-list building, it starts executing the command, use EVE_cmd_execute() to wait for completion, does not support cmd-burst */
 void EVE_cmd_loadimage(uint32_t ptr, uint32_t options, const uint8_t *data, uint16_t len)
 {
 	EVE_begin_cmd(CMD_LOADIMAGE);
@@ -567,21 +849,6 @@ void EVE_cmd_loadimage(uint32_t ptr, uint32_t options, const uint8_t *data, uint
 }
 
 
-#if defined (FT81X_ENABLE)
-/* this is meant to be called outside display-list building, does not support cmd-burst */
-void EVE_cmd_mediafifo(uint32_t ptr, uint32_t size)
-{
-	EVE_begin_cmd(CMD_MEDIAFIFO);
-	BUFFER_SPI_DWORD(ptr)
-	BUFFER_SPI_DWORD(size)
-
-	EVE_inc_cmdoffset(8);
-
-	SEND_SPI_BUFFER()
-}
-#endif
-
-
 /* this is meant to be called outside display-list building, does not support cmd-burst */
 void EVE_cmd_interrupt(uint32_t ms)
 {
@@ -1009,6 +1276,10 @@ uint8_t EVE_init(void)
 
 	EVE_get_cmdoffset(); /* just to be safe */
 
+#if EVE_USE_INT
+	EVE_int_init();
+#endif
+
 #if defined (EVE_DMA)
 	EVE_init_dma(); /* prepare DMA */
 #endif
@@ -1024,9 +1295,10 @@ Be careful to not use any functions in the sequence that do not address the comm
 */
 void EVE_start_cmd_burst(void)
 {
+	EVE_cmd_wait_space(SPI_BUFFER_SIZE);	// a burst is limited by the SPI buffer
+
 	cmd_burst = 42;
 
-	WAIT_SPI()	// it is important to wait before writing to the SPI buffer as it might be in a DMA transaction
 	BUFFER_SPI_WRITE_ADDRESS(EVE_RAM_CMD + cmdOffset)
 }
 
@@ -1044,7 +1316,7 @@ void EVE_start_cmd(uint32_t command)
 {
 	if(!cmd_burst)
 	{
-		WAIT_SPI()	// it is important to wait before writing to the SPI buffer as it might be in a DMA transaction
+		EVE_cmd_wait_space(SPI_BUFFER_SIZE);
 		BUFFER_SPI_WRITE_ADDRESS(EVE_RAM_CMD + cmdOffset)
 	}
 
@@ -1116,7 +1388,7 @@ void EVE_write_string(const char *text)
 /* EVE3 FLASH functions */
 #if defined (BT81X_ENABLE)
 
-/* this is meant to be called outside display-list building, it includes executing the command and waiting for completion, does not support cmd-burst */
+/* this is meant to be called outside display-list building, it starts executing the command, use EVE_cmd_execute() to wait for completion, does not support cmd-burst */
 /* write "num" bytes from *data to the external flash on a BT81x board at address ptr */
 /* note: ptr must be 256 byte aligned, num must be a multiple of 256 */
 /* note: EVE will not do anything if the alignment requirements are not met */
@@ -1244,7 +1516,7 @@ uint32_t EVE_cmd_flashfast(void)
 }
 
 
-/* this is meant to be called outside display-list building, it includes executing the command and waiting for completion, does not support cmd-burst */
+/* this is meant to be called outside display-list building, it starts executing the command, use EVE_cmd_execute() to wait for completion, does not support cmd-burst */
 /* write "num" bytes from *data to the BT81x SPI interface */
 /* note: raw direct access, not really useful for anything */
 void EVE_cmd_flashspitx(uint32_t num, const uint8_t *data)
@@ -1795,17 +2067,14 @@ void EVE_cmd_setbitmap(uint32_t addr, uint16_t fmt, uint16_t width, uint16_t hei
 }
 #endif
 
-#if FT81X_FULL
-void EVE_cmd_number(int16_t x0, int16_t y0, int16_t font, uint16_t options, int32_t number)
+
+void EVE_cmd_append(uint32_t ptr, uint32_t num)
 {
-	EVE_start_cmd(CMD_NUMBER);
-	BUFFER_SPI_WORD(x0)
-	BUFFER_SPI_WORD(y0)
-	BUFFER_SPI_WORD(font)
-	BUFFER_SPI_WORD(options)
-	BUFFER_SPI_DWORD(number)
+	EVE_start_cmd(CMD_APPEND);
+	BUFFER_SPI_DWORD(ptr)
+	BUFFER_SPI_DWORD(num)
 
-	EVE_inc_cmdoffset(12);
+	EVE_inc_cmdoffset(8);
 
 	if(!cmd_burst)
 	{
@@ -1814,13 +2083,17 @@ void EVE_cmd_number(int16_t x0, int16_t y0, int16_t font, uint16_t options, int3
 }
 
 
-void EVE_cmd_append(uint32_t ptr, uint32_t num)
+#if FT81X_FULL
+void EVE_cmd_number(int16_t x0, int16_t y0, int16_t font, uint16_t options, int32_t number)
 {
-	EVE_start_cmd(CMD_APPEND);
-	BUFFER_SPI_DWORD(ptr)
-	BUFFER_SPI_DWORD(num)
+	EVE_start_cmd(CMD_NUMBER);
+	BUFFER_SPI_WORD(x0)
+	BUFFER_SPI_WORD(y0)
+	BUFFER_SPI_WORD(font)
+	BUFFER_SPI_WORD(options)
+	BUFFER_SPI_DWORD(number)
 
-	EVE_inc_cmdoffset(8);
+	EVE_inc_cmdoffset(12);
 
 	if(!cmd_burst)
 	{
@@ -37,6 +37,9 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 #define EVE_COMMANDS_H_
 
 #define BLOCK_TRANSFER_SIZE 3840		// block transfer size when write data to CMD buffer
+#define EVE_CMDFIFO_WAIT_POLLS 8		// REG_CMD_READ polls before waiting for the co-processor sleeps
+#define EVE_SPI_BUFFERS 4				// SPI buffers commands are built in, in turn
+#define EVE_READ_BLOCK_MAX 64			// bytes read per transaction by EVE_memRead_block()
 
 void DELAY_MS(uint16_t ms);
 
@@ -53,6 +56,7 @@ void EVE_cmdWrite(uint8_t command, uint8_t parameter);
 uint8_t EVE_memRead8(uint32_t ftAddress);
 uint16_t EVE_memRead16(uint32_t ftAddress);
 uint32_t EVE_memRead32(uint32_t ftAddress);
+void EVE_memRead_block(uint32_t ftAddress, uint8_t *data, uint32_t len);
 
 void EVE_memWrite8(uint32_t ftAddress, uint8_t ftData8);
 void EVE_memWrite16(uint32_t ftAddress, uint16_t ftData16);
@@ -64,6 +68,16 @@ uint8_t EVE_busy(void);
 
 void EVE_get_cmdoffset(void);
 
+uint16_t EVE_cmd_space(void);
+
+void EVE_cmd_wait_space(uint16_t space);
+
+#if EVE_USE_INT
+/* interrupts reported on the INT pin, for other drivers to avoid polling EVE */
+bool EVE_int_enable(uint8_t mask);
+uint8_t EVE_int_take_flags(uint8_t mask);
+#endif
+
 
 /* commands to operate on memory: */
 void EVE_cmd_memzero(uint32_t ptr, uint32_t num);
@@ -71,14 +85,16 @@ void EVE_cmd_memset(uint32_t ptr, uint8_t value, uint32_t num);
 void EVE_cmd_memwrite(uint32_t dest, uint32_t num, const uint8_t *data);
 void EVE_cmd_memcpy(uint32_t dest, uint32_t src, uint32_t num);
 
-#if FT81X_FULL
 /* commands for loading image data into FT8xx memory: */
 void EVE_cmd_inflate(uint32_t ptr, const uint8_t *data, uint16_t len);
-void EVE_cmd_loadimage(uint32_t ptr, uint32_t options, const uint8_t *data, uint16_t len);
 
 #if defined (FT81X_ENABLE)
 void EVE_cmd_mediafifo(uint32_t ptr, uint32_t size);
+void EVE_cmd_playvideo(uint32_t options);
 #endif
+
+#if FT81X_FULL
+void EVE_cmd_loadimage(uint32_t ptr, uint32_t options, const uint8_t *data, uint16_t len);
 #endif // FT81X_FULL
 
 void EVE_cmd_start(void);
@@ -155,10 +171,10 @@ void EVE_cmd_setbitmap(uint32_t addr, uint16_t fmt, uint16_t width, uint16_t hei
 #endif
 
 
-#if FT81X_FULL
 void EVE_cmd_append(uint32_t ptr, uint32_t num);
 
 
+#if FT81X_FULL
 /* commands for setting the bitmap transform matrix: */
 void EVE_cmd_getmatrix(int32_t a, int32_t b, int32_t c, int32_t d, int32_t e, int32_t f);
 void EVE_cmd_translate(int32_t tx, int32_t ty);
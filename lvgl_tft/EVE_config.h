@@ -51,10 +51,11 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 #define EVE_PDN		    CONFIG_LV_DISP_PIN_RST	// grey
 #define EVE_USE_PDN		CONFIG_LV_DISP_USE_RST
 
-#if defined (DISP_BUF_SIZE)
-#define SPI_TRANSER_SIZE (DISP_BUF_SIZE * (LV_COLOR_DEPTH / 8))
+#if defined (CONFIG_LV_FT81X_USE_INT)
+#define EVE_INT		    CONFIG_LV_FT81X_PIN_INT
+#define EVE_USE_INT		1
 #else
-    /* ToDo Update using new API */
+#define EVE_USE_INT		0
 #endif
 
 #define BYTES_PER_PIXEL (LV_COLOR_DEPTH / 8)	// bytes per pixel for (16 for RGB565)
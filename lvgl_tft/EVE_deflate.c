@@ -0,0 +1,269 @@
+/*
+@file    EVE_deflate.c
+@brief   minimal zlib (RFC 1950/1951) encoder for CMD_INFLATE uploads
+@version 4.1 LvGL edition
+
+@section info
+
+Trades compression ratio for speed, like the fastest zlib level:
+- a single block with the fixed Huffman codes, no code tables to build or send
+- one hash table probe per position, matches are not searched for further and positions inside a match are not hashed
+
+LVGL renders flat areas and repeated lines, which end up as long matches at a distance of one pixel or one line,
+so this still compresses UI content several-fold while the encoder runs at a fraction of the cost of the SPI transfer it saves.
+*/
+
+#include <string.h>
+
+#include "EVE_deflate.h"
+
+#define HASH_BITS	12
+#define HASH_SIZE	(1UL << HASH_BITS)
+#define HASH_NONE	UINT32_MAX
+
+#define MIN_MATCH	4		// shorter matches hardly beat literals with the fixed codes, and an RGB565 pixel is 2 bytes
+#define MAX_MATCH	258
+#define MAX_DIST	32768
+
+#define ADLER_MOD	65521UL
+#define ADLER_NMAX	5552	// bytes summed before the sums have to be reduced to stay within 32 bits
+
+typedef struct {
+	uint8_t *out;
+	uint8_t *end;
+	uint32_t bits;
+	uint8_t count;
+	uint8_t overflow;
+} bit_writer;
+
+static const uint16_t len_base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t len_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t dist_base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static uint32_t hash_head[HASH_SIZE];	// last position seen for each hash of 4 bytes
+
+/* fixed Huffman codes, bit reversed since Huffman codes are packed starting with their MSB */
+static uint16_t lit_code[288];
+static uint8_t lit_bits[288];
+static uint8_t dist_code[30];
+static uint8_t codes_ready = 0;
+
+
+static uint16_t reverse_bits(uint16_t code, uint8_t bits)
+{
+	uint16_t reversed = 0;
+
+	for(uint8_t i = 0; i < bits; i++)
+	{
+		reversed = (reversed << 1) | (code & 1);
+		code >>= 1;
+	}
+
+	return reversed;
+}
+
+
+static void init_codes(void)
+{
+	for(uint16_t sym = 0; sym < 288; sym++)
+	{
+		if(sym < 144)
+		{
+			lit_bits[sym] = 8;
+			lit_code[sym] = reverse_bits(0x30 + sym, 8);
+		}
+		else if(sym < 256)
+		{
+			lit_bits[sym] = 9;
+			lit_code[sym] = reverse_bits(0x190 + (sym - 144), 9);
+		}
+		else if(sym < 280)
+		{
+			lit_bits[sym] = 7;
+			lit_code[sym] = reverse_bits(sym - 256, 7);
+		}
+		else
+		{
+			lit_bits[sym] = 8;
+			lit_code[sym] = reverse_bits(0xc0 + (sym - 280), 8);
+		}
+	}
+
+	for(uint8_t sym = 0; sym < 30; sym++)
+	{
+		dist_code[sym] = reverse_bits(sym, 5);
+	}
+
+	codes_ready = 1;
+}
+
+
+/* append bits, LSB first */
+static inline void put_bits(bit_writer *bw, uint32_t value, uint8_t bits)
+{
+	bw->bits |= value << bw->count;
+	bw->count += bits;
+
+	while(bw->count >= 8)
+	{
+		if(bw->out == bw->end)
+		{
+			bw->overflow = 1;
+			bw->count = 0;
+			return;
+		}
+
+		*bw->out++ = (uint8_t)bw->bits;
+		bw->bits >>= 8;
+		bw->count -= 8;
+	}
+}
+
+
+static inline void put_symbol(bit_writer *bw, uint16_t sym)
+{
+	put_bits(bw, lit_code[sym], lit_bits[sym]);
+}
+
+
+static void put_match(bit_writer *bw, uint32_t length, uint32_t distance)
+{
+	uint8_t code = 28;
+	while(len_base[code] > length)
+	{
+		code--;
+	}
+
+	put_symbol(bw, 257 + code);
+	if(len_extra[code])
+	{
+		put_bits(bw, length - len_base[code], len_extra[code]);
+	}
+
+	code = 29;
+	while(dist_base[code] > distance)
+	{
+		code--;
+	}
+
+	put_bits(bw, dist_code[code], 5);
+	if(dist_extra[code])
+	{
+		put_bits(bw, distance - dist_base[code], dist_extra[code]);
+	}
+}
+
+
+static inline uint32_t hash4(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return (uint32_t)(v * 2654435761U) >> (32 - HASH_BITS);
+}
+
+
+static uint32_t adler32(const uint8_t *data, uint32_t len)
+{
+	uint32_t a = 1;
+	uint32_t b = 0;
+
+	while(len > 0)
+	{
+		uint32_t chunk = (len > ADLER_NMAX) ? ADLER_NMAX : len;
+		len -= chunk;
+
+		while(chunk--)
+		{
+			a += *data++;
+			b += a;
+		}
+
+		a %= ADLER_MOD;
+		b %= ADLER_MOD;
+	}
+
+	return (b << 16) | a;
+}
+
+
+uint32_t EVE_deflate(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t dst_len)
+{
+	/* 2 bytes of zlib header and 4 of Adler-32 trailer around the deflate block */
+	if(dst_len < 8)
+	{
+		return 0;
+	}
+
+	if(!codes_ready)
+	{
+		init_codes();
+	}
+
+	bit_writer bw = {
+		.out = dst + 2,
+		.end = dst + dst_len - 4,
+	};
+
+	dst[0] = 0x78;	/* CMF: deflate, 32K window */
+	dst[1] = 0x01;	/* FLG: fastest compression, no dictionary, makes CMF/FLG a multiple of 31 */
+
+	memset(hash_head, 0xff, sizeof(hash_head));
+
+	put_bits(&bw, 1, 1);	/* BFINAL */
+	put_bits(&bw, 1, 2);	/* BTYPE: fixed Huffman codes */
+
+	uint32_t pos = 0;
+	while((pos < len) && !bw.overflow)
+	{
+		uint32_t match_len = 0;
+		uint32_t match_dist = 0;
+
+		if((pos + MIN_MATCH) <= len)
+		{
+			uint32_t hash = hash4(src + pos);
+			uint32_t candidate = hash_head[hash];
+			hash_head[hash] = pos;
+
+			if((candidate != HASH_NONE) && ((pos - candidate) <= MAX_DIST))
+			{
+				uint32_t max_len = ((len - pos) > MAX_MATCH) ? MAX_MATCH : (len - pos);
+
+				while((match_len < max_len) && (src[candidate + match_len] == src[pos + match_len]))
+				{
+					match_len++;
+				}
+
+				match_dist = pos - candidate;
+			}
+		}
+
+		if(match_len >= MIN_MATCH)
+		{
+			put_match(&bw, match_len, match_dist);
+			pos += match_len;
+		}
+		else
+		{
+			put_symbol(&bw, src[pos]);
+			pos++;
+		}
+	}
+
+	put_symbol(&bw, 256);	/* end of block */
+	put_bits(&bw, 0, 7);	/* flush the last partial byte */
+
+	if(bw.overflow)
+	{
+		return 0;
+	}
+
+	uint32_t adler = adler32(src, len);
+	*bw.out++ = (uint8_t)(adler >> 24);
+	*bw.out++ = (uint8_t)(adler >> 16);
+	*bw.out++ = (uint8_t)(adler >> 8);
+	*bw.out++ = (uint8_t)adler;
+
+	return bw.out - dst;
+}
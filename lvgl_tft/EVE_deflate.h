@@ -0,0 +1,17 @@
+/*
+@file    EVE_deflate.h
+@brief   minimal zlib (RFC 1950/1951) encoder for CMD_INFLATE uploads
+@version 4.1 LvGL edition
+*/
+
+#ifndef EVE_DEFLATE_H_
+#define EVE_DEFLATE_H_
+
+#include <stdint.h>
+
+/* Compress len bytes from src into a zlib stream in dst, for the co-processor to inflate with CMD_INFLATE. */
+/* Returns the size of the stream, or 0 if it doesn't fit in dst_len bytes: pass the largest size worth */
+/* sending compressed to also bound the time spent on data that doesn't compress well. */
+uint32_t EVE_deflate(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t dst_len);
+
+#endif /* EVE_DEFLATE_H_ */
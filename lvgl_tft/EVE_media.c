@@ -0,0 +1,139 @@
+/*
+@file    EVE_media.c
+@brief   streams videos into the EVE media FIFO for the co-processor to play
+@version 4.1 LvGL edition
+
+@section info
+
+The video is copied into a ring buffer in RAM_G, the media FIFO, from which CMD_PLAYVIDEO decodes and shows it, so
+the ESP32 only moves bytes. The stream is read in chunks into one of two DMA capable buffers while the other one is
+still being sent, and REG_MEDIAFIFO_WRITE is only advanced over data that arrived in RAM_G. The co-processor reads
+at the pace of the video, chunks are held back until REG_MEDIAFIFO_READ shows room for them.
+
+All functions send SPI commands, so they have to be called from the task flushing LvGL.
+*/
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+
+#include "EVE_media.h"
+#include "EVE_commands.h"
+
+#if defined (FT81X_ENABLE)
+
+#define MEDIA_WAIT_MS	2	// sleep while the FIFO is full, a chunk lasts much longer at any sensible bitrate
+
+
+/* read until the chunk is full or the stream ended, so only the last chunk is short */
+static uint32_t read_chunk(EVE_media_read_cb read, void *ctx, uint8_t *buf)
+{
+	uint32_t len = 0;
+
+	while(len < EVE_MEDIA_CHUNK)
+	{
+		uint32_t got = read(ctx, buf + len, EVE_MEDIA_CHUNK - len);
+		if(got == 0)
+		{
+			break;
+		}
+		len += got;
+	}
+
+	return len;
+}
+
+
+/* free bytes in the FIFO behind the write offset, a DWORD is kept clear so a full FIFO does not look empty */
+static uint32_t fifo_space(uint32_t fifo_size, uint32_t wr)
+{
+	uint32_t rd = EVE_memRead32(REG_MEDIAFIFO_READ);
+
+	return (rd + fifo_size - wr - 4) % fifo_size;
+}
+
+
+bool EVE_media_play_video(uint32_t fifo, uint32_t fifo_size, uint32_t options, EVE_media_read_cb read, void *ctx)
+{
+	fifo_size &= ~3UL;
+	if(fifo_size <= EVE_MEDIA_CHUNK)
+	{
+		return false;
+	}
+
+	uint8_t *chunks = heap_caps_malloc(2 * EVE_MEDIA_CHUNK, MALLOC_CAP_DMA);
+	if(chunks == NULL)
+	{
+		return false;
+	}
+
+	EVE_cmd_mediafifo(fifo, fifo_size);
+	EVE_cmd_execute();
+
+	uint32_t wr = EVE_memRead32(REG_MEDIAFIFO_WRITE);	// offset behind the data sent so far
+	bool playing = false;
+	uint8_t *chunk = chunks;
+	uint32_t len = read_chunk(read, ctx, chunk);
+
+	while(len > 0)
+	{
+		uint32_t padded = (len + 3) & ~3UL;		// the FIFO is written in DWORDs, the end of the stream is padded
+		memset(chunk + len, 0, padded - len);
+
+		EVE_memWrite32(REG_MEDIAFIFO_WRITE, wr);	// waits for the previous chunk to be sent
+
+		while(fifo_space(fifo_size, wr) < padded)
+		{
+			if(!playing)
+			{
+				// start once the FIFO is full, so the first frames don't wait for data
+				EVE_cmd_playvideo(options | EVE_OPT_MEDIAFIFO);
+				EVE_cmd_start();
+				playing = true;
+			}
+			else if(!EVE_busy())
+			{
+				len = 0;	// the video ended before the stream, what is left of it is not needed
+				break;
+			}
+
+			DELAY_MS(MEDIA_WAIT_MS);
+		}
+
+		if(len == 0)
+		{
+			break;
+		}
+
+		// split at the end of the ring
+		uint32_t first = fifo_size - wr;
+		if(first >= padded)
+		{
+			EVE_memWrite_buffer(fifo + wr, chunk, padded, false);
+		}
+		else
+		{
+			EVE_memWrite_buffer(fifo + wr, chunk, first, false);
+			EVE_memWrite_buffer(fifo, chunk + first, padded - first, false);
+		}
+		wr = (wr + padded) % fifo_size;
+
+		// read the next chunk while this one is sent
+		chunk = (chunk == chunks) ? (chunks + EVE_MEDIA_CHUNK) : chunks;
+		len = read_chunk(read, ctx, chunk);
+	}
+
+	EVE_memWrite32(REG_MEDIAFIFO_WRITE, wr);
+
+	if(!playing)
+	{
+		EVE_cmd_playvideo(options | EVE_OPT_MEDIAFIFO);
+	}
+	EVE_cmd_execute();	// returns once CMD_PLAYVIDEO is done
+
+	heap_caps_free(chunks);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,27 @@
+/*
+@file    EVE_media.h
+@brief   streams videos into the EVE media FIFO for the co-processor to play
+@version 4.1 LvGL edition
+*/
+
+#ifndef EVE_MEDIA_H_
+#define EVE_MEDIA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "EVE.h"
+
+#define EVE_MEDIA_CHUNK		4096	// bytes read and sent at a time, two chunks are allocated while playing
+
+/* Fill buf with up to len bytes of the stream, returns the number of bytes read, 0 at the end of the stream. */
+typedef uint32_t (*EVE_media_read_cb)(void *ctx, uint8_t *buf, uint32_t len);
+
+#if defined (FT81X_ENABLE)
+/* Play an AVI video with MJPEG frames through a media FIFO of fifo_size bytes at RAM_G address fifo. */
+/* options are passed to CMD_PLAYVIDEO, EVE_OPT_MEDIAFIFO is added. Returns once the video ended, false if it */
+/* could not be started. The co-processor is busy with the video until then, so nothing else can be drawn. */
+bool EVE_media_play_video(uint32_t fifo, uint32_t fifo_size, uint32_t options, EVE_media_read_cb read, void *ctx);
+#endif
+
+#endif /* EVE_MEDIA_H_ */
@@ -1,12 +1,22 @@
 
 #include <stdio.h>
+#include <string.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
 
+#include "disp_spi.h"
 #include "FT81x.h"
 
 #include "EVE.h"
 #include "EVE_commands.h"
+#include "EVE_deflate.h"
+#include "EVE_assets.h"
+#include "EVE_media.h"
 
 /* some pre-definded colors */
 #define RED		0xff0000UL
@@ -23,8 +33,115 @@
 /* memory-map defines */
 #define SCREEN_BITMAP_ADDR	0x00000000	// full screen buffer (0x00000000 - 0x000‭‭BBE40‬)
 
+/* double buffering, see FT81x_flush(), only if both screen buffers fit in RAM_G */
+#if defined (CONFIG_LV_FT81X_DOUBLE_BUFFER) && ((2 * SCREEN_BUFFER_SIZE) <= EVE_RAM_G_SIZE)
+#define FT81X_DOUBLE_BUFFER	1
+#define SCREEN_BITMAP2_ADDR	(SCREEN_BITMAP_ADDR + SCREEN_BUFFER_SIZE)	// second screen buffer
+#define SCREEN_BUFFERS_SIZE	(2 * SCREEN_BUFFER_SIZE)
+#define FRONT_ADDR			front_addr		// screen buffer shown
+#define BACK_ADDR			back_addr		// screen buffer flushes are written to
+#define DIRTY_MAX			16				// areas tracked per frame, more are merged
+#else
+#define FT81X_DOUBLE_BUFFER	0
+#define SCREEN_BUFFERS_SIZE	SCREEN_BUFFER_SIZE
+#define FRONT_ADDR			SCREEN_BITMAP_ADDR
+#define BACK_ADDR			SCREEN_BITMAP_ADDR
+#endif
+
+#if defined (CONFIG_LV_FT81X_ASSET_CACHE)
+#define ASSETS_SIZE			(CONFIG_LV_FT81X_ASSET_CACHE_SIZE * 1024L)
+#else
+#define ASSETS_SIZE			0
+#endif
+#define ASSETS_ADDR			(SCREEN_BITMAP_ADDR + SCREEN_BUFFERS_SIZE)	// images and fonts uploaded once, after the screen buffer(s)
+
+// staging area for partial updates, up to the end of RAM_G; it is only used while the co-processor works through the
+// commands queued with it, so it can share the top of RAM_G with the PNG decoder while the asset cache stays clear of it
+#define SCRATCH_ADDR		(ASSETS_ADDR + ASSETS_SIZE)
+#define SCRATCH_SIZE		(EVE_RAM_G_SIZE - SCRATCH_ADDR)
+
+#if SCRATCH_ADDR > EVE_RAM_G_SIZE
+#error "The FT81x asset cache does not fit in RAM_G next to the screen buffer, reduce LV_FT81X_ASSET_CACHE_SIZE"
+#endif
+
+#define MEMCPY_PER_BURST	((SPI_BUFFER_SIZE - 3) / 16)	// CMD_MEMCPY takes 4 DWORDs, a burst also sends the 3 byte address
+
+/* solid fill overlays, see FT81x_flush() */
+#define OVERLAY_MAX			8		// overlays in the display list, each takes 16 bytes of the 256 byte cmd-burst
+#define OVERLAY_MIN_PIXELS	1024	// smaller solid areas are cheaper to upload than to track
+
+/* compressed uploads, see TFT_WriteBitmap_deflate() */
+#define DEFLATE_MIN_BYTES	2048	// below this the commands and the wait for the DMA cost more than the transfer saved
+#define DEFLATE_MAX_PERCENT	50		// areas compressing worse than this are sent raw
+#define DEFLATE_BACKOFF		8		// flushes sent raw after an area didn't compress
+#define DEFLATE_MAX_LEN		0xfffcUL	// CMD_INFLATE is passed a 16 bit length
+
+/* image layers, see FT81x_image_layer_show() */
+#define IMAGE_LAYER_MAX		4
+
+/* display list fragments, see FT81x_dl_fragment_set() */
+#define DL_FRAGMENT_MAX		4
+
+typedef struct {
+	lv_area_t area;
+	lv_color_t color;
+} overlay_t;
+
+typedef struct {
+	uint32_t asset;
+	uint32_t addr;
+	uint16_t format;
+	uint16_t width;
+	uint16_t height;
+	lv_coord_t x;
+	lv_coord_t y;
+	bool shown;
+} image_layer_t;
+
+#if defined (CONFIG_LV_FT81X_ASSET_CACHE)
+typedef struct {
+	FT81x_dl_build_cb_t build;
+	void *user_data;
+	uint32_t asset;
+	uint32_t addr;
+	uint16_t size;		// bytes of display list
+	bool recorded;
+	bool locked;
+	bool used;
+} dl_fragment_t;
+#endif
+
 uint8_t tft_active = 0;
 
+#if defined (CONFIG_LV_FT81X_SOLID_FILL_OVERLAY)
+static overlay_t overlays[OVERLAY_MAX];
+static uint8_t overlay_count = 0;
+static DMA_ATTR lv_color_t overlay_line[EVE_HSIZE];	// one line of an overlay color, DMA capable
+#endif
+
+#if defined (CONFIG_LV_FT81X_ASSET_CACHE)
+static image_layer_t image_layers[IMAGE_LAYER_MAX];
+static dl_fragment_t dl_fragments[DL_FRAGMENT_MAX];
+#endif
+
+#if FT81X_DOUBLE_BUFFER
+static uint32_t front_addr = SCREEN_BITMAP_ADDR;
+static uint32_t back_addr = SCREEN_BITMAP2_ADDR;
+static lv_area_t dirty[DIRTY_MAX];			// areas drawn into the back buffer in this frame
+static uint8_t dirty_count = 0;
+static lv_area_t copy_forward[DIRTY_MAX];	// areas of the last frame the back buffer is missing
+static uint8_t copy_forward_count = 0;
+static bool swap_pending = false;
+#endif
+
+static FT81x_stats_t stats;
+
+#if defined (CONFIG_LV_FT81X_COMPRESSED_UPLOAD)
+static uint8_t *deflate_buf = NULL;
+static uint32_t deflate_buf_len = 0;
+static uint8_t deflate_backoff = 0;
+#endif
+
 void touch_calibrate(void)
 {
 
@@ -226,11 +343,60 @@ void touch_calibrate(void)
 }
 
 
+#if defined (CONFIG_LV_FT81X_ASSET_CACHE)
+// have the co-processor build the display list of a fragment and keep it in the asset cache, to be appended to every
+// display list from there with CMD_APPEND instead of being built again
+static void dl_fragment_record(dl_fragment_t *fragment)
+{
+	// RAM_DL is double buffered, without a swap this only writes over the list shown next, which is built after this
+	EVE_cmd_dl(CMD_DLSTART);
+	fragment->build(fragment->user_data);
+	EVE_cmd_execute();
+
+	uint16_t size = EVE_memRead16(REG_CMD_DL);	// bytes written to RAM_DL since CMD_DLSTART
+
+	if(fragment->locked)
+	{
+		EVE_asset_unlock(fragment->asset);	// it may have to move to grow
+		fragment->locked = false;
+	}
+
+	uint32_t addr = EVE_asset_reserve(fragment->asset, size);
+	if(addr == EVE_ASSET_NONE)
+	{
+		LV_LOG_WARN("No room for a %u byte display list fragment", size);
+		fragment->used = false;
+		return;
+	}
+
+	EVE_asset_lock(fragment->asset);
+	fragment->locked = true;
+
+	EVE_cmd_memcpy(addr, EVE_RAM_DL, size);
+	EVE_cmd_execute();
+
+	fragment->addr = addr;
+	fragment->size = size;
+	fragment->recorded = true;
+}
+#endif
+
+
 // set up a display list for a fullscreen writable bitmap
 void TFT_bitmap_display(void)
 {
 	if(tft_active != 0)
 	{
+#if defined (CONFIG_LV_FT81X_ASSET_CACHE)
+		for(uint8_t i = 0; i < DL_FRAGMENT_MAX; i++)
+		{
+			if(dl_fragments[i].used && !dl_fragments[i].recorded)
+			{
+				dl_fragment_record(&dl_fragments[i]);
+			}
+		}
+#endif
+
 		EVE_start_cmd_burst(); /* start writing to the cmd-fifo as one stream of bytes, only sending the address once */
 
 		EVE_cmd_dl(CMD_DLSTART); /* start the display list */
@@ -242,13 +408,62 @@ void TFT_bitmap_display(void)
 
 		// fullscreen bitmap for memory-mapped direct access
 		EVE_cmd_dl(TAG(20));
-		EVE_cmd_setbitmap(SCREEN_BITMAP_ADDR, EVE_RGB565, EVE_HSIZE, EVE_VSIZE);
+		EVE_cmd_setbitmap(FRONT_ADDR, EVE_RGB565, EVE_HSIZE, EVE_VSIZE);
 		EVE_cmd_dl(DL_BEGIN | EVE_BITMAPS);
 		EVE_cmd_dl(VERTEX2F(0, 0));
 		EVE_cmd_dl(DL_END);
 
 		EVE_cmd_dl(TAG(0));
 
+#if defined (CONFIG_LV_FT81X_SOLID_FILL_OVERLAY)
+		// solid areas are cleared to their color on top of the bitmap instead of being uploaded into it
+		for(uint8_t i = 0; i < overlay_count; i++)
+		{
+			const lv_area_t *area = &overlays[i].area;
+
+			EVE_cmd_dl(SCISSOR_XY(area->x1, area->y1));
+			EVE_cmd_dl(SCISSOR_SIZE(lv_area_get_width(area), lv_area_get_height(area)));
+			EVE_cmd_dl(DL_CLEAR_RGB | (lv_color_to32(overlays[i].color) & 0xffffffUL));
+			EVE_cmd_dl(DL_CLEAR | CLR_COL);
+		}
+
+		// open the scissor up again, the image layers and fragments drawn next must not be clipped to the last overlay
+		EVE_cmd_dl(SCISSOR_XY(0, 0));
+		EVE_cmd_dl(SCISSOR_SIZE(EVE_HSIZE, EVE_VSIZE));
+#endif
+
+#if defined (CONFIG_LV_FT81X_ASSET_CACHE)
+		// cached images and display list fragments drawn on top, in a burst of their own as they don't fit in the
+		// first one with all the overlays
+		EVE_end_cmd_burst();
+		EVE_start_cmd_burst();
+
+		EVE_cmd_dl(DL_BEGIN | EVE_BITMAPS);
+
+		for(uint8_t i = 0; i < IMAGE_LAYER_MAX; i++)
+		{
+			const image_layer_t *layer = &image_layers[i];
+
+			if(layer->shown)
+			{
+				EVE_cmd_setbitmap(layer->addr, layer->format, layer->width, layer->height);
+				EVE_cmd_dl(VERTEX2F(layer->x * 16, layer->y * 16));
+			}
+		}
+
+		EVE_cmd_dl(DL_END);
+
+		for(uint8_t i = 0; i < DL_FRAGMENT_MAX; i++)
+		{
+			if(dl_fragments[i].used && dl_fragments[i].recorded)
+			{
+				EVE_cmd_dl(SAVE_CONTEXT());
+				EVE_cmd_append(dl_fragments[i].addr, dl_fragments[i].size);
+				EVE_cmd_dl(RESTORE_CONTEXT());
+			}
+		}
+#endif
+
 		EVE_cmd_dl(DL_DISPLAY);	/* instruct the graphics processor to show the list */
 
 		EVE_cmd_dl(CMD_SWAP); /* make this list active */
@@ -274,6 +489,10 @@ void FT81x_init(void)
 
 	spi_acquire();
 
+#if defined (CONFIG_LV_FT81X_DOUBLE_BUFFER) && !FT81X_DOUBLE_BUFFER
+	LV_LOG_WARN("Two screen buffers don't fit in RAM_G, using one");
+#endif
+
 	if(EVE_init())
 	{
 		tft_active = 1;
@@ -282,9 +501,13 @@ void FT81x_init(void)
 
 		touch_calibrate();
 
-		EVE_cmd_memset(SCREEN_BITMAP_ADDR, BLACK, SCREEN_BUFFER_SIZE);		// clear screen buffer
+		EVE_cmd_memset(SCREEN_BITMAP_ADDR, BLACK, SCREEN_BUFFERS_SIZE);		// clear screen buffer(s)
 		EVE_cmd_execute();
 
+#if defined (CONFIG_LV_FT81X_ASSET_CACHE)
+		EVE_assets_init(ASSETS_ADDR, ASSETS_SIZE);
+#endif
+
 		TFT_bitmap_display();	// set DL for fullscreen bitmap display
 	}
 
@@ -295,7 +518,35 @@ void FT81x_init(void)
 // write fullscreen bitmap directly
 void TFT_WriteScreen(uint8_t* Bitmap)
 {
-	EVE_memWrite_buffer(SCREEN_BITMAP_ADDR, Bitmap, SCREEN_BUFFER_SIZE, false);
+	EVE_memWrite_buffer(BACK_ADDR, Bitmap, SCREEN_BUFFER_SIZE, false);
+}
+
+
+// have the co-processor copy the lines of an area into place in a screen buffer
+static void copy_lines(uint32_t addr, uint32_t src, uint32_t src_stride, uint32_t bpl, uint16_t Height)
+{
+	for(uint16_t i = 0; i < Height; i += MEMCPY_PER_BURST)
+	{
+		uint16_t lines = ((Height - i) > MEMCPY_PER_BURST) ? MEMCPY_PER_BURST : (Height - i);
+
+		// the upload may still be in flight, the commands only run after EVE_cmd_start() waits for the SPI and writes REG_CMD_WRITE
+		EVE_start_cmd_burst();
+
+		for(uint16_t j = 0; j < lines; j++)
+		{
+			EVE_cmd_dl(CMD_MEMCPY);
+			EVE_cmd_dl(addr);
+			EVE_cmd_dl(src);
+			EVE_cmd_dl(bpl);
+
+			addr += BYTES_PER_LINE;
+			src += src_stride;
+		}
+
+		EVE_end_cmd_burst();
+	}
+
+	EVE_cmd_start();
 }
 
 
@@ -303,13 +554,25 @@ void TFT_WriteScreen(uint8_t* Bitmap)
 void TFT_WriteBitmap(uint8_t* Bitmap, uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height)
 {
 	// calc base address
-	uint32_t addr = SCREEN_BITMAP_ADDR + (Y * BYTES_PER_LINE) + (X * BYTES_PER_PIXEL);
+	uint32_t addr = BACK_ADDR + (Y * BYTES_PER_LINE) + (X * BYTES_PER_PIXEL);
 
 	// can we do a fast full width block transfer?
 	if(X == 0 && Width == EVE_HSIZE)
 	{
 		EVE_memWrite_buffer(addr, Bitmap, (Height * BYTES_PER_LINE), true);
 	}
+	else if((Height > 1) && ((uint32_t)Height * Width * BYTES_PER_PIXEL <= SCRATCH_SIZE))
+	{
+		// upload the area as one block into the scratch area and let the co-processor copy the lines into place,
+		// one DMA burst and a few commands instead of an address prefixed transaction per line
+		uint32_t bpl = Width * BYTES_PER_PIXEL;
+
+		EVE_cmd_execute();	// the co-processor may still be copying the previous area out of the scratch area
+
+		EVE_memWrite_buffer(SCRATCH_ADDR, Bitmap, Height * bpl, true);
+
+		copy_lines(addr, SCRATCH_ADDR, bpl, bpl, Height);
+	}
 	else
 	{
 		// line by line mode
@@ -322,8 +585,530 @@ void TFT_WriteBitmap(uint8_t* Bitmap, uint16_t X, uint16_t Y, uint16_t Width, ui
 	}
 }
 
+#if defined (CONFIG_LV_FT81X_COMPRESSED_UPLOAD)
+// write bitmap deflate compressed, the co-processor inflates it into place
+// returns false if the area is not worth compressing, it has to be written raw then
+//
+// Unlike raw writes the inflated data goes through the command FIFO, so there is no need to wait for the co-processor
+// to finish copying the previous area out of the scratch area before reusing it. The flush is complete once this returns.
+static bool TFT_WriteBitmap_deflate(const uint8_t* Bitmap, uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height)
+{
+	uint32_t addr = BACK_ADDR + (Y * BYTES_PER_LINE) + (X * BYTES_PER_PIXEL);
+	uint32_t bpl = Width * BYTES_PER_PIXEL;
+	uint32_t len = Height * bpl;
+	bool full_width = (X == 0) && (Width == EVE_HSIZE);
+
+	if((len < DEFLATE_MIN_BYTES) || (!full_width && (len > SCRATCH_SIZE)))
+	{
+		return false;
+	}
+
+	if(deflate_backoff > 0)
+	{
+		deflate_backoff--;
+		return false;
+	}
+
+	// the output is bounded by the ratio worth sending, so data that doesn't compress is given up on early
+	uint32_t max_len = (len * DEFLATE_MAX_PERCENT) / 100;
+	if(max_len > DEFLATE_MAX_LEN)
+	{
+		max_len = DEFLATE_MAX_LEN;
+	}
+
+	disp_wait_for_pending_transactions();	// the buffer may still be in a DMA transaction
+
+	if(max_len > deflate_buf_len)
+	{
+		heap_caps_free(deflate_buf);
+		deflate_buf = heap_caps_malloc(max_len, MALLOC_CAP_DMA);
+		deflate_buf_len = (deflate_buf != NULL) ? max_len : 0;
+
+		if(deflate_buf == NULL)
+		{
+			LV_LOG_WARN("No memory for a %u byte deflate buffer", max_len);
+			deflate_backoff = DEFLATE_BACKOFF;
+			return false;
+		}
+	}
+
+	uint32_t deflated = EVE_deflate(Bitmap, len, deflate_buf, max_len);
+	if(deflated == 0)
+	{
+		deflate_backoff = DEFLATE_BACKOFF;
+		return false;
+	}
+
+	if(full_width)
+	{
+		EVE_cmd_inflate(addr, deflate_buf, deflated);
+	}
+	else
+	{
+		EVE_cmd_inflate(SCRATCH_ADDR, deflate_buf, deflated);
+		copy_lines(addr, SCRATCH_ADDR, bpl, bpl, Height);
+	}
+
+	return true;
+}
+#endif
+
+
+// write a flushed area, signals LittlevGL once its buffer is free again
+static void write_area(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
+{
+#if defined (CONFIG_LV_FT81X_COMPRESSED_UPLOAD)
+	if(TFT_WriteBitmap_deflate((const uint8_t*)color_map, area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area)))
+	{
+		stats.deflated++;
+		lv_disp_flush_ready(drv);
+		return;
+	}
+#endif
+
+	TFT_WriteBitmap((uint8_t*)color_map, area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area));	// the last transaction signals the flush
+}
+
+
+#if FT81X_DOUBLE_BUFFER
+// remember an area drawn into the back buffer, to be copied forward after the swap
+static void mark_dirty(const lv_area_t *area)
+{
+	if(dirty_count < DIRTY_MAX)
+	{
+		dirty[dirty_count++] = *area;
+		return;
+	}
+
+	// out of slots, grow the last one to cover the area as well
+	lv_area_t *last = &dirty[DIRTY_MAX - 1];
+	last->x1 = LV_MIN(last->x1, area->x1);
+	last->y1 = LV_MIN(last->y1, area->y1);
+	last->x2 = LV_MAX(last->x2, area->x2);
+	last->y2 = LV_MAX(last->y2, area->y2);
+}
+
+
+// before drawing into the back buffer: wait for the last swap to take effect, then bring the back buffer up to date
+// with the areas of the last frame, so only what changed has to be flushed into it
+static void back_buffer_prepare(void)
+{
+	if(!swap_pending)
+	{
+		return;
+	}
+
+	EVE_cmd_execute();	// the co-processor has to get to the CMD_SWAP first
+
+	// REG_DLSWAP goes back to 0 once the display list is swapped at the end of the frame being scanned out,
+	// until then the back buffer is still shown
+	while(EVE_memRead8(REG_DLSWAP) != 0)
+	{
+		vTaskDelay(1);
+	}
+
+	for(uint8_t i = 0; i < copy_forward_count; i++)
+	{
+		const lv_area_t *area = &copy_forward[i];
+		uint32_t offset = (area->y1 * BYTES_PER_LINE) + (area->x1 * BYTES_PER_PIXEL);
+		uint16_t width = lv_area_get_width(area);
+
+		if(width == EVE_HSIZE)
+		{
+			EVE_cmd_memcpy(back_addr + offset, front_addr + offset, lv_area_get_height(area) * BYTES_PER_LINE);
+		}
+		else
+		{
+			copy_lines(back_addr + offset, front_addr + offset, BYTES_PER_LINE, width * BYTES_PER_PIXEL, lv_area_get_height(area));
+		}
+	}
+
+	if(copy_forward_count > 0)
+	{
+		EVE_cmd_execute();	// flushes write into the back buffer directly, not through the command FIFO
+	}
+
+	copy_forward_count = 0;
+	swap_pending = false;
+}
+
+
+// show the back buffer once the frame is complete
+static void back_buffer_swap(void)
+{
+	uint32_t drawn = back_addr;
+
+	back_addr = front_addr;
+	front_addr = drawn;
+
+	TFT_bitmap_display();	// the pixels are queued before the display list, it is shown once they are in
+
+	memcpy(copy_forward, dirty, dirty_count * sizeof(lv_area_t));
+	copy_forward_count = dirty_count;
+	dirty_count = 0;
+	swap_pending = true;
+}
+#endif
+
+
+// show what was flushed
+static void display_update(lv_disp_drv_t * drv, bool changed)
+{
+#if FT81X_DOUBLE_BUFFER
+	// the display list only changes with the swap at the end of the frame
+	if(lv_disp_flush_is_last(drv))
+	{
+		back_buffer_swap();
+	}
+#else
+	if(changed)
+	{
+		TFT_bitmap_display();	// the pixels are queued before the display list, it is shown once they are in
+	}
+#endif
+}
+
+
+#if defined (CONFIG_LV_FT81X_SOLID_FILL_OVERLAY)
+// check if all the pixels of an area have the same color
+static bool area_is_solid(const lv_color_t *color_map, uint32_t px_num)
+{
+	for(uint32_t i = 1; i < px_num; i++)
+	{
+		if(color_map[i].full != color_map[0].full)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// write the color of an overlay into the bitmap, so it can be dropped from the display list
+static void overlay_materialize(const overlay_t *overlay)
+{
+	uint16_t width = lv_area_get_width(&overlay->area);
+	uint32_t addr = BACK_ADDR + (overlay->area.y1 * BYTES_PER_LINE) + (overlay->area.x1 * BYTES_PER_PIXEL);
+
+	disp_wait_for_pending_transactions();	// the line buffer may still be in a DMA transaction
+
+	for(uint16_t i = 0; i < width; i++)
+	{
+		overlay_line[i] = overlay->color;
+	}
+
+	for(lv_coord_t y = overlay->area.y1; y <= overlay->area.y2; y++)
+	{
+		EVE_memWrite_buffer(addr, (uint8_t*)overlay_line, width * BYTES_PER_PIXEL, false);
+		addr += BYTES_PER_LINE;
+	}
+
+#if FT81X_DOUBLE_BUFFER
+	mark_dirty(&overlay->area);
+#endif
+}
+
+
+// drop the overlays a flushed area draws over, the ones it only partially covers are written into the bitmap first
+// returns true if an overlay was dropped
+static bool overlays_clip(const lv_area_t *area)
+{
+	bool changed = false;
+	uint8_t kept = 0;
+
+	for(uint8_t i = 0; i < overlay_count; i++)
+	{
+		lv_area_t common;
+
+		if(!_lv_area_intersect(&common, &overlays[i].area, area))
+		{
+			overlays[kept++] = overlays[i];
+			continue;
+		}
+
+		if(!_lv_area_is_in(&overlays[i].area, area, 0))
+		{
+			overlay_materialize(&overlays[i]);
+		}
+
+		changed = true;
+	}
+
+	overlay_count = kept;
+
+	return changed;
+}
+#endif
+
+
 // LittlevGL flush callback
+//
+// With CONFIG_LV_FT81X_SOLID_FILL_OVERLAY areas of a single color (backgrounds, panels, large fills) are not uploaded,
+// they are added to the display list as a scissored CLEAR over the bitmap instead: 16 bytes of commands instead of
+// 2 bytes per pixel. Areas flushed later over an overlay replace it.
+//
+// With CONFIG_LV_FT81X_COMPRESSED_UPLOAD areas are deflated and sent with CMD_INFLATE when they compress well.
+//
+// With CONFIG_LV_FT81X_DOUBLE_BUFFER (and room for it in RAM_G) flushes are written into a back buffer which is
+// swapped in once the last area of a frame is flushed, so the screen never shows a frame half drawn. After the swap
+// the co-processor copies the areas of that frame into the new back buffer, instead of LittlevGL redrawing them.
 void FT81x_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-	TFT_WriteBitmap((uint8_t*)color_map, area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area));
+	bool changed = false;	// the display list has to be rebuilt
+
+	stats.flushes++;
+	stats.pixel_bytes += lv_area_get_size(area) * sizeof(lv_color_t);
+	if(lv_disp_flush_is_last(drv))
+	{
+		stats.frames++;
+	}
+
+#if FT81X_DOUBLE_BUFFER
+	back_buffer_prepare();
+#endif
+
+#if defined (CONFIG_LV_FT81X_SOLID_FILL_OVERLAY)
+	uint32_t px_num = lv_area_get_size(area);
+	changed = overlays_clip(area);
+
+	if((px_num >= OVERLAY_MIN_PIXELS) && (overlay_count < OVERLAY_MAX) && area_is_solid(color_map, px_num))
+	{
+		overlays[overlay_count].area = *area;
+		overlays[overlay_count].color = color_map[0];
+		overlay_count++;
+		stats.overlays++;
+
+		display_update(drv, true);
+		lv_disp_flush_ready(drv);
+		return;
+	}
+#endif
+
+	write_area(drv, area, color_map);
+
+#if FT81X_DOUBLE_BUFFER
+	mark_dirty(area);
+#endif
+
+	display_update(drv, changed);
+}
+
+
+#if defined (CONFIG_LV_FT81X_ASSET_CACHE)
+// show an image from the asset cache on top of the screen, see FT81x.h
+bool FT81x_image_layer_show(uint8_t layer, uint32_t asset, uint16_t format, uint16_t width, uint16_t height, lv_coord_t x, lv_coord_t y)
+{
+	if(layer >= IMAGE_LAYER_MAX)
+	{
+		return false;
+	}
+
+	uint32_t addr = EVE_asset_find(asset);
+	if(addr == EVE_ASSET_NONE)
+	{
+		return false;
+	}
+
+	image_layer_t *l = &image_layers[layer];
+
+	EVE_asset_lock(asset);	// lock the new asset first, the layer may show the same one already
+	if(l->shown)
+	{
+		EVE_asset_unlock(l->asset);
+	}
+
+	l->asset = asset;
+	l->addr = addr;
+	l->format = format;
+	l->width = width;
+	l->height = height;
+	l->x = x;
+	l->y = y;
+	l->shown = true;
+
+	TFT_bitmap_display();
+
+	return true;
+}
+
+
+void FT81x_image_layer_hide(uint8_t layer)
+{
+	if((layer >= IMAGE_LAYER_MAX) || !image_layers[layer].shown)
+	{
+		return;
+	}
+
+	EVE_asset_unlock(image_layers[layer].asset);
+	image_layers[layer].shown = false;
+
+	TFT_bitmap_display();
+}
+
+
+// draw a display list fragment on top of the screen, see FT81x.h
+bool FT81x_dl_fragment_set(uint8_t fragment, uint32_t asset, FT81x_dl_build_cb_t build, void *user_data)
+{
+	if(fragment >= DL_FRAGMENT_MAX)
+	{
+		return false;
+	}
+
+	FT81x_dl_fragment_remove(fragment);
+
+	dl_fragment_t *f = &dl_fragments[fragment];
+
+	f->build = build;
+	f->user_data = user_data;
+	f->asset = asset;
+	f->recorded = false;
+	f->used = true;
+
+	TFT_bitmap_display();	// records it
+
+	return f->used;
+}
+
+
+void FT81x_dl_fragment_invalidate(uint8_t fragment)
+{
+	if((fragment >= DL_FRAGMENT_MAX) || !dl_fragments[fragment].used)
+	{
+		return;
+	}
+
+	dl_fragments[fragment].recorded = false;
+
+	TFT_bitmap_display();
+}
+
+
+void FT81x_dl_fragment_remove(uint8_t fragment)
+{
+	if((fragment >= DL_FRAGMENT_MAX) || !dl_fragments[fragment].used)
+	{
+		return;
+	}
+
+	dl_fragment_t *f = &dl_fragments[fragment];
+
+	if(f->locked)
+	{
+		EVE_asset_unlock(f->asset);
+		f->locked = false;
+	}
+	EVE_asset_evict(f->asset);
+	f->used = false;
+
+	TFT_bitmap_display();
+}
+
+
+#if LVGL_VERSION_MAJOR >= 8
+static void dl_fragment_event_cb(lv_event_t * e)
+{
+	uint8_t fragment = (uint8_t)(uintptr_t)lv_event_get_user_data(e);
+
+	switch(lv_event_get_code(e))
+	{
+		case LV_EVENT_VALUE_CHANGED:
+		case LV_EVENT_SIZE_CHANGED:
+		case LV_EVENT_STYLE_CHANGED:
+			FT81x_dl_fragment_invalidate(fragment);
+			break;
+
+		case LV_EVENT_DELETE:
+			FT81x_dl_fragment_remove(fragment);
+			break;
+
+		default:
+			break;
+	}
+}
+
+
+void FT81x_dl_fragment_bind(uint8_t fragment, lv_obj_t * obj)
+{
+	lv_obj_add_event_cb(obj, dl_fragment_event_cb, LV_EVENT_ALL, (void *)(uintptr_t)fragment);
+}
+#endif
+#endif
+
+
+void FT81x_get_stats(FT81x_stats_t * stats_out)
+{
+	*stats_out = stats;
+}
+
+
+// play a video with the co-processor, see FT81x.h
+bool FT81x_play_video(FT81x_video_read_cb_t read, void *ctx, bool sound)
+{
+#if defined (FT81X_ENABLE)
+	if(tft_active == 0)
+	{
+		return false;
+	}
+
+	// the media FIFO takes the scratch area, it is only used during flushes
+	uint32_t options = EVE_OPT_FULLSCREEN | EVE_OPT_NOTEAR | (sound ? EVE_OPT_SOUND : 0);
+	if(!EVE_media_play_video(SCRATCH_ADDR, SCRATCH_SIZE, options, read, ctx))
+	{
+		LV_LOG_ERROR("Video not played, %u bytes of RAM_G left for the media FIFO", (unsigned)SCRATCH_SIZE);
+		return false;
+	}
+
+	// the frames were decoded into RAM_G, the screen has to be drawn again
+	TFT_bitmap_display();
+	lv_obj_invalidate(lv_scr_act());
+
+	return true;
+#else
+	LV_LOG_WARN("Videos need an FT81x or BT81x");
+	return false;
+#endif
+}
+
+
+typedef struct {
+	const esp_partition_t *partition;
+	uint32_t offset;
+	uint32_t len;
+} partition_stream_t;
+
+static uint32_t partition_read(void *ctx, uint8_t *buf, uint32_t len)
+{
+	partition_stream_t *stream = ctx;
+
+	if(len > (stream->len - stream->offset))
+	{
+		len = stream->len - stream->offset;
+	}
+
+	if((len == 0) || (esp_partition_read(stream->partition, stream->offset, buf, len) != ESP_OK))
+	{
+		return 0;
+	}
+
+	stream->offset += len;
+
+	return len;
+}
+
+
+bool FT81x_play_video_partition(const char * label, uint32_t len, bool sound)
+{
+	partition_stream_t stream = {0};
+
+	stream.partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+	if(stream.partition == NULL)
+	{
+		LV_LOG_ERROR("No data partition for the video");
+		return false;
+	}
+
+	stream.len = ((len == 0) || (len > stream.partition->size)) ? stream.partition->size : len;
+
+	return FT81x_play_video(partition_read, &stream, sound);
 }
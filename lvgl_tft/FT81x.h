@@ -2,6 +2,7 @@
 #define FT81X_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef LV_LVGL_H_INCLUDE_SIMPLE
 #include "lvgl.h"
@@ -14,4 +15,55 @@ void FT81x_init(void);
 
 void FT81x_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map);
 
+/* Flush counters since FT81x_init(). The bytes it took to send them are counted by disp_spi_get_stats(), the */
+/* difference of its tx_bytes between two snapshots divided by the frames in between gives the bytes per frame. */
+typedef struct {
+	uint32_t frames;		// frames flushed, counted at their last area
+	uint32_t flushes;		// areas flushed
+	uint64_t pixel_bytes;	// size of the areas flushed, what uploading all of them as is takes
+	uint32_t overlays;		// areas drawn as solid overlays, see CONFIG_LV_FT81X_SOLID_FILL_OVERLAY
+	uint32_t deflated;		// areas sent compressed, see CONFIG_LV_FT81X_COMPRESSED_UPLOAD
+} FT81x_stats_t;
+
+void FT81x_get_stats(FT81x_stats_t * stats);
+
+#if defined (CONFIG_LV_FT81X_ASSET_CACHE)
+/* Images uploaded once into the RAM_G asset cache (see EVE_assets.h) are drawn by EVE from there on top of the */
+/* LittlevGL screen, instead of being drawn by LittlevGL and flushed with every redraw of their area. */
+/* Show an asset of the given EVE bitmap format (EVE_RGB565, EVE_ARGB4, ...) in one of the layers, it stays */
+/* locked in the cache while shown. Returns false if the asset is not loaded. Call from the LittlevGL task. */
+bool FT81x_image_layer_show(uint8_t layer, uint32_t asset, uint16_t format, uint16_t width, uint16_t height, lv_coord_t x, lv_coord_t y);
+void FT81x_image_layer_hide(uint8_t layer);
+
+/* Display list fragments are built once by the co-processor from EVE commands (EVE_cmd_dl(), EVE_cmd_text(), ...) */
+/* issued by a callback, kept in the asset cache and appended to the display list on top of the screen and the */
+/* image layers. A fragment is only built again once invalidated, it is not resent with every display list. */
+typedef void (*FT81x_dl_build_cb_t)(void *user_data);
+
+/* Set one of the fragments, stored as the given asset id. Returns false if it does not fit in the cache. */
+bool FT81x_dl_fragment_set(uint8_t fragment, uint32_t asset, FT81x_dl_build_cb_t build, void *user_data);
+/* Build a fragment again, call when whatever it shows changed. */
+void FT81x_dl_fragment_invalidate(uint8_t fragment);
+void FT81x_dl_fragment_remove(uint8_t fragment);
+
+#if LVGL_VERSION_MAJOR >= 8
+/* Invalidate a fragment when the value, size or style of a LittlevGL object it shows changes and remove it */
+/* with the object. With LittlevGL 7 call FT81x_dl_fragment_invalidate() from the object's event callback. */
+void FT81x_dl_fragment_bind(uint8_t fragment, lv_obj_t * obj);
+#endif
+#endif
+
+/* Full-screen videos (boot and idle animations) are decoded and shown by the co-processor, the video is only */
+/* streamed into its media FIFO: AVI files with MJPEG frames, optionally with mono u-law audio, no larger than the */
+/* screen. Playing blocks the LittlevGL task until the video ended, the screen is drawn again afterwards. */
+
+/* Fill buf with up to len bytes of the video, returns the number of bytes read, 0 at the end of the video. */
+typedef uint32_t (*FT81x_video_read_cb_t)(void *ctx, uint8_t *buf, uint32_t len);
+
+/* Play a video from any source, a file for example, returns false if it could not be played. */
+bool FT81x_play_video(FT81x_video_read_cb_t read, void *ctx, bool sound);
+/* Play a video stored in the data partition with the given label, len is the length of the video or 0 to stream */
+/* the partition until the video ends. */
+bool FT81x_play_video_partition(const char * label, uint32_t len, bool sound);
+
 #endif /* FT81X_H_ */
@@ -0,0 +1,89 @@
+/**
+ * @file epd_greyscale.c
+ *
+ * Splits the 2 bits per pixel frame into the two bit planes uploaded to the
+ * e-paper controllers. The split works on 32 bit words, 16 pixels at a time:
+ * the pixels' bits are interleaved (MSB, LSB, MSB, LSB...) so a bit unshuffle
+ * moves all the MSBs to the upper half word and all the LSBs to the lower
+ * one, in four shift/mask steps instead of a loop over every pixel.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <esp_heap_caps.h>
+
+#include "epd_greyscale.h"
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static inline uint32_t epd_grey_unshuffle(uint32_t x);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+bool epd_grey_planes_init(epd_grey_planes_t *planes, size_t len)
+{
+    if (planes->msb) {
+        return true;
+    }
+
+    /* Both planes are streamed to the controller by DMA */
+    planes->msb = heap_caps_malloc(len, MALLOC_CAP_DMA);
+    planes->lsb = heap_caps_malloc(len, MALLOC_CAP_DMA);
+
+    if (!planes->msb || !planes->lsb) {
+        LV_LOG_ERROR("No memory for the greyscale planes (%u bytes each)", len);
+        heap_caps_free(planes->msb);
+        heap_caps_free(planes->lsb);
+        planes->msb = NULL;
+        planes->lsb = NULL;
+        return false;
+    }
+
+    planes->len = len;
+    return true;
+}
+
+void epd_grey_split(epd_grey_planes_t *planes, const uint8_t *grey)
+{
+    uint8_t *msb = planes->msb;
+    uint8_t *lsb = planes->lsb;
+
+    /* 4 grey bytes give 2 bytes of each plane */
+    for (size_t idx = 0; idx < planes->len; idx += 2) {
+        uint32_t x = ((uint32_t) grey[0] << 24) | ((uint32_t) grey[1] << 16) |
+                     ((uint32_t) grey[2] << 8) | grey[3];
+        grey += 4;
+
+        x = epd_grey_unshuffle(x);
+
+        *msb++ = x >> 24;
+        *msb++ = x >> 16;
+        *lsb++ = x >> 8;
+        *lsb++ = x;
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/* Gather the odd bits of x into the upper half word and the even bits into
+ * the lower one, keeping their order */
+static inline uint32_t epd_grey_unshuffle(uint32_t x)
+{
+    uint32_t t;
+
+    t = (x ^ (x >> 1)) & 0x22222222u;
+    x = x ^ t ^ (t << 1);
+    t = (x ^ (x >> 2)) & 0x0c0c0c0cu;
+    x = x ^ t ^ (t << 2);
+    t = (x ^ (x >> 4)) & 0x00f000f0u;
+    x = x ^ t ^ (t << 4);
+    t = (x ^ (x >> 8)) & 0x0000ff00u;
+    x = x ^ t ^ (t << 8);
+
+    return x;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file epd_greyscale.h
+ *
+ * 4 level greyscale support shared by the e-paper display drivers.
+ *
+ * LVGL renders into a 2 bits per pixel buffer laid out like the driver's
+ * 1 bit per pixel framebuffer, with every byte of the latter widened to two
+ * bytes: the pixel at bit (7 - n) of mono byte i lives in bits
+ * (7 - 2 * (n % 4)) and (6 - 2 * (n % 4)) of byte (2 * i + n / 4). Before
+ * a refresh the buffer is split into two 1 bit per pixel planes, holding the
+ * most and least significant bit of each grey level, which the drivers
+ * upload as the controller's NEW and OLD data.
+ */
+
+#ifndef EPD_GREYSCALE_H
+#define EPD_GREYSCALE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef LV_LVGL_H_INCLUDE_SIMPLE
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+#include "sdkconfig.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+#define EPD_BITS_PER_PIXEL      2
+#else
+#define EPD_BITS_PER_PIXEL      1
+#endif
+
+/* Grey levels, 0 is black and 3 is white */
+#define EPD_GREY_BLACK          0u
+#define EPD_GREY_WHITE          3u
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint8_t *msb;       /* Most significant bit of every pixel */
+    uint8_t *lsb;       /* Least significant bit of every pixel */
+    size_t len;         /* Length of each plane, bytes */
+} epd_grey_planes_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Allocate the bit planes
+ *
+ * @param planes    Planes to allocate, in DMA capable memory
+ * @param len       Length of a 1 bit per pixel framebuffer, bytes, multiple of 2
+ * @return          true on success
+ */
+bool epd_grey_planes_init(epd_grey_planes_t *planes, size_t len);
+
+/**
+ * @brief Split a 2 bits per pixel buffer into the bit planes
+ *
+ * @param planes    Destination planes
+ * @param grey      Source buffer, 2 * planes->len bytes long
+ */
+void epd_grey_split(epd_grey_planes_t *planes, const uint8_t *grey);
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**
+ * @brief Grey level of an LVGL color
+ */
+static inline uint8_t epd_grey_level(lv_color_t color)
+{
+    return lv_color_brightness(color) >> 6;
+}
+
+/**
+ * @brief Store the grey level of a pixel
+ *
+ * @param buf           2 bits per pixel buffer
+ * @param byte_index    Index of the byte holding the pixel in the 1 bit per pixel layout
+ * @param bit_index     Position of the pixel in that byte, 0 is the MSB
+ * @param level         Grey level, 0 to 3
+ */
+static inline void epd_grey_set_px(uint8_t *buf, size_t byte_index, uint8_t bit_index, uint8_t level)
+{
+    uint8_t *dst = buf + (byte_index * 2) + (bit_index >> 2);
+    uint8_t shift = 6 - ((bit_index & 0x03) * 2);
+
+    *dst = (*dst & ~(0x03 << shift)) | (level << shift);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* EPD_GREYSCALE_H */
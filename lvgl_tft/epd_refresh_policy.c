@@ -0,0 +1,192 @@
+/**
+ * @file epd_refresh_policy.c
+ *
+ * Partial refreshes are fast but every one of them leaves a bit of ghosting
+ * behind on the pixels it changed. Instead of cleaning the panel every N
+ * partial refreshes regardless of what was drawn, the panel is split into
+ * tiles and the pixels changed in each tile are accumulated. Once a tile
+ * exceeds its ghosting budget the tiles over budget get a clean (full
+ * waveform) refresh limited to their bounding window, or a full refresh
+ * when that window covers most of the panel anyway.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "epd_refresh_policy.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/* Tile size, 32x32 pixels */
+#define EPD_TILE_BYTES          4u
+#define EPD_TILE_ROWS           32u
+#define EPD_TILE_PIXELS         (EPD_TILE_BYTES * 8u * EPD_TILE_ROWS)
+
+/* A clean window covering more than this share of the panel becomes a full refresh */
+#define EPD_CLEAN_MAX_PCT       50u
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void epd_tile_area(const epd_refresh_policy_t *policy, uint16_t tx, uint16_t ty, lv_area_t *area);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+bool epd_refresh_policy_init(epd_refresh_policy_t *policy, uint16_t width, uint16_t height,
+                             uint16_t budget_pct, uint16_t max_partials)
+{
+    policy->width = width;
+    policy->height = height;
+    policy->row_len = width / 8u;
+    policy->tiles_x = (policy->row_len + EPD_TILE_BYTES - 1) / EPD_TILE_BYTES;
+    policy->tiles_y = (height + EPD_TILE_ROWS - 1) / EPD_TILE_ROWS;
+    policy->tile_budget = (EPD_TILE_PIXELS * budget_pct) / 100u;
+    policy->max_partials = max_partials;
+    policy->partials = 0;
+
+    free(policy->changed);
+    policy->changed = calloc(policy->tiles_x * policy->tiles_y, sizeof(uint32_t));
+
+    if (!policy->changed) {
+        LV_LOG_WARN("No memory for the ghosting counters, falling back to a fixed full refresh cadence");
+        return false;
+    }
+
+    return true;
+}
+
+epd_refresh_t epd_refresh_policy_evaluate(epd_refresh_policy_t *policy, const uint8_t *prev,
+                                          const uint8_t *next, lv_area_t *win)
+{
+    if (!prev || (policy->max_partials == 0) || (policy->partials >= policy->max_partials)) {
+        epd_refresh_policy_mark_clean(policy, NULL);
+        return EPD_REFRESH_FULL;
+    }
+
+    const int32_t row_len = policy->row_len;
+    int32_t col_min = row_len, col_max = -1;
+    int32_t row_min = policy->height, row_max = -1;
+
+    for (int32_t row = 0; row < policy->height; row++) {
+        const uint8_t *new_row = next + (row * row_len);
+        const uint8_t *old_row = prev + (row * row_len);
+
+        if (memcmp(new_row, old_row, row_len) == 0) continue;
+
+        uint32_t *tiles = NULL;
+        if (policy->changed) {
+            tiles = policy->changed + ((row / EPD_TILE_ROWS) * policy->tiles_x);
+        }
+
+        for (int32_t col = 0; col < row_len; col++) {
+            uint8_t diff = new_row[col] ^ old_row[col];
+            if (!diff) continue;
+
+            if (col < col_min) col_min = col;
+            if (col > col_max) col_max = col;
+            if (tiles) tiles[col / EPD_TILE_BYTES] += __builtin_popcount(diff);
+        }
+
+        if (row_min == policy->height) row_min = row;
+        row_max = row;
+    }
+
+    if (row_max < 0) {
+        return EPD_REFRESH_NONE;
+    }
+
+    win->x1 = col_min * 8;
+    win->x2 = (col_max * 8) + 7;
+    win->y1 = row_min;
+    win->y2 = row_max;
+
+    policy->partials++;
+
+    if (!policy->changed) {
+        return EPD_REFRESH_PARTIAL;
+    }
+
+    /* Bounding window of the tiles over budget */
+    lv_area_t clean = { .x1 = policy->width, .y1 = policy->height, .x2 = -1, .y2 = -1 };
+
+    for (uint16_t ty = 0; ty < policy->tiles_y; ty++) {
+        for (uint16_t tx = 0; tx < policy->tiles_x; tx++) {
+            if (policy->changed[(ty * policy->tiles_x) + tx] <= policy->tile_budget) continue;
+
+            lv_area_t tile;
+            epd_tile_area(policy, tx, ty, &tile);
+            if (tile.x1 < clean.x1) clean.x1 = tile.x1;
+            if (tile.y1 < clean.y1) clean.y1 = tile.y1;
+            if (tile.x2 > clean.x2) clean.x2 = tile.x2;
+            if (tile.y2 > clean.y2) clean.y2 = tile.y2;
+        }
+    }
+
+    if (clean.x2 < 0) {
+        return EPD_REFRESH_PARTIAL;
+    }
+
+    /* The clean window has to cover the changed pixels as well */
+    if (win->x1 < clean.x1) clean.x1 = win->x1;
+    if (win->y1 < clean.y1) clean.y1 = win->y1;
+    if (win->x2 > clean.x2) clean.x2 = win->x2;
+    if (win->y2 > clean.y2) clean.y2 = win->y2;
+
+    uint32_t clean_px = (uint32_t) (clean.x2 - clean.x1 + 1) * (uint32_t) (clean.y2 - clean.y1 + 1);
+    uint32_t panel_px = (uint32_t) policy->width * policy->height;
+
+    if ((clean_px * 100u) > (panel_px * EPD_CLEAN_MAX_PCT)) {
+        LV_LOG_INFO("Ghosting budget exceeded on most of the panel, full refresh");
+        epd_refresh_policy_mark_clean(policy, NULL);
+        return EPD_REFRESH_FULL;
+    }
+
+    LV_LOG_INFO("Ghosting budget exceeded, clean refresh of x1: %d, y1: %d, x2: %d, y2: %d",
+                clean.x1, clean.y1, clean.x2, clean.y2);
+
+    *win = clean;
+    epd_refresh_policy_mark_clean(policy, win);
+    return EPD_REFRESH_CLEAN;
+}
+
+void epd_refresh_policy_mark_clean(epd_refresh_policy_t *policy, const lv_area_t *win)
+{
+    if (!win) {
+        policy->partials = 0;
+    }
+
+    if (!policy->changed) {
+        return;
+    }
+
+    for (uint16_t ty = 0; ty < policy->tiles_y; ty++) {
+        for (uint16_t tx = 0; tx < policy->tiles_x; tx++) {
+            lv_area_t tile;
+            epd_tile_area(policy, tx, ty, &tile);
+
+            /* Only tiles cleaned as a whole start over */
+            if (win && ((tile.x1 < win->x1) || (tile.y1 < win->y1) ||
+                        (tile.x2 > win->x2) || (tile.y2 > win->y2))) {
+                continue;
+            }
+
+            policy->changed[(ty * policy->tiles_x) + tx] = 0;
+        }
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static void epd_tile_area(const epd_refresh_policy_t *policy, uint16_t tx, uint16_t ty, lv_area_t *area)
+{
+    area->x1 = tx * EPD_TILE_BYTES * 8u;
+    area->y1 = ty * EPD_TILE_ROWS;
+    area->x2 = LV_MIN(area->x1 + (EPD_TILE_BYTES * 8u) - 1, policy->width - 1u);
+    area->y2 = LV_MIN(area->y1 + EPD_TILE_ROWS - 1, policy->height - 1u);
+}
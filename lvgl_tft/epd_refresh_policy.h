@@ -0,0 +1,102 @@
+/**
+ * @file epd_refresh_policy.h
+ *
+ * Decides between partial, region limited clean and full refreshes for the
+ * e-paper drivers, based on how much each region of the panel changed since
+ * it was last cleaned.
+ */
+
+#ifndef EPD_REFRESH_POLICY_H
+#define EPD_REFRESH_POLICY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef LV_LVGL_H_INCLUDE_SIMPLE
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    EPD_REFRESH_NONE,       /* Nothing changed */
+    EPD_REFRESH_PARTIAL,    /* Fast waveform limited to the window */
+    EPD_REFRESH_CLEAN,      /* Full waveform limited to the window */
+    EPD_REFRESH_FULL,       /* Full waveform on the whole panel */
+} epd_refresh_t;
+
+typedef struct {
+    uint16_t width;             /* Panel width, pixels */
+    uint16_t height;            /* Panel height, pixels */
+    uint16_t row_len;           /* Framebuffer bytes per row */
+    uint16_t tiles_x;
+    uint16_t tiles_y;
+    uint32_t *changed;          /* Changed pixels per tile since the tile was last cleaned */
+    uint32_t tile_budget;       /* Changed pixels a tile takes before it needs cleaning */
+    uint16_t max_partials;      /* Partial refreshes between full refreshes, 0 always refreshes in full */
+    uint16_t partials;          /* Partial refreshes since the last full refresh */
+} epd_refresh_policy_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Initialise a refresh policy
+ *
+ * The framebuffer is expected in the 1 bit per pixel, row major layout used
+ * by the JD79653A and UC8151D drivers, MSB first.
+ *
+ * @param policy        Policy to initialise
+ * @param width         Panel width in pixels, multiple of 8
+ * @param height        Panel height in pixels
+ * @param budget_pct    Ghosting budget, changed pixels per tile as a percentage of the tile area
+ * @param max_partials  Upper bound of partial refreshes between two full refreshes
+ * @return              false if the per tile counters can't be allocated
+ */
+bool epd_refresh_policy_init(epd_refresh_policy_t *policy, uint16_t width, uint16_t height,
+                             uint16_t budget_pct, uint16_t max_partials);
+
+/**
+ * @brief Decide how to draw the next frame
+ *
+ * Accounts the pixels changed between prev and next to their tiles, then
+ * picks the refresh kind. The refresh counts as done once this returns, the
+ * caller is expected to perform it.
+ *
+ * @param policy    Refresh policy
+ * @param prev      Frame shown on the panel, NULL if unknown
+ * @param next      Frame to draw
+ * @param win       Set to the byte aligned window to refresh for
+ *                  EPD_REFRESH_PARTIAL and EPD_REFRESH_CLEAN
+ * @return          Kind of refresh to perform
+ */
+epd_refresh_t epd_refresh_policy_evaluate(epd_refresh_policy_t *policy, const uint8_t *prev,
+                                          const uint8_t *next, lv_area_t *win);
+
+/**
+ * @brief Forget the ghosting accumulated in a region
+ *
+ * Called by evaluate for clean and full refreshes, drivers call it as well
+ * when they redraw the panel by other means (e.g. filling it with a color).
+ *
+ * @param policy    Refresh policy
+ * @param win       Cleaned region, NULL for the whole panel
+ */
+void epd_refresh_policy_mark_clean(epd_refresh_policy_t *policy, const lv_area_t *win);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* EPD_REFRESH_POLICY_H */
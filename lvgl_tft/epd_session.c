@@ -0,0 +1,207 @@
+/**
+ * @file epd_session.c
+ *
+ * Powering an e-paper panel up and down (or waking it from deep sleep) costs
+ * about as much as the refresh itself. Wrapping every update in a power cycle
+ * doubles the latency of bursts of updates, so the drivers open a session
+ * around each update instead: the panel is powered up by the first update and
+ * only powered down once no update arrived for the idle timeout.
+ *
+ * Powering down sends SPI commands and waits for the BUSY signal, which must
+ * not happen in the esp_timer task shared by the whole system. The idle timer
+ * only wakes a small task of the session, which takes the session lock and
+ * powers the panel down.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+#ifdef LV_LVGL_H_INCLUDE_SIMPLE
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+#include "epd_session.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define EPD_SESSION_TASK_PRIORITY   2
+#define EPD_SESSION_TASK_STACK_SIZE 3072
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    SemaphoreHandle_t lock;
+    esp_timer_handle_t idle_timer;
+    TaskHandle_t idle_task;     /* Powers the panel down once the idle timer fired */
+    epd_session_power_cb_t power_on;
+    epd_session_power_cb_t power_off;
+    uint64_t idle_timeout_us;
+    int64_t last_end_us;        /* End of the last update */
+    bool powered;
+    epd_session_stats_t stats;
+} epd_session_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void epd_session_idle_cb(void *arg);
+static void epd_session_idle_task(void *arg);
+static void epd_session_power_down(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static epd_session_t epd_session;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+bool epd_session_init(epd_session_power_cb_t power_on, epd_session_power_cb_t power_off, uint32_t idle_timeout_ms)
+{
+    assert((power_on != NULL) && (power_off != NULL));
+
+    if (!epd_session.lock) {
+        epd_session.lock = xSemaphoreCreateMutex();
+        if (!epd_session.lock) {
+            LV_LOG_ERROR("Failed to create the session lock");
+            return false;
+        }
+    }
+
+    if (!epd_session.idle_timer && (idle_timeout_ms > 0)) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = epd_session_idle_cb,
+            .name = "epd_idle",
+        };
+
+        if (xTaskCreate(epd_session_idle_task, "epd_idle", EPD_SESSION_TASK_STACK_SIZE,
+                        NULL, EPD_SESSION_TASK_PRIORITY, &epd_session.idle_task) != pdPASS) {
+            LV_LOG_WARN("Failed to create the idle task, powering down after every update");
+            epd_session.idle_task = NULL;
+        } else if (esp_timer_create(&timer_args, &epd_session.idle_timer) != ESP_OK) {
+            LV_LOG_WARN("Failed to create the idle timer, powering down after every update");
+            epd_session.idle_timer = NULL;
+            vTaskDelete(epd_session.idle_task);
+            epd_session.idle_task = NULL;
+        }
+    }
+
+    epd_session.power_on = power_on;
+    epd_session.power_off = power_off;
+    epd_session.idle_timeout_us = (uint64_t) idle_timeout_ms * 1000u;
+    epd_session.powered = false;
+
+    return true;
+}
+
+void epd_session_begin(void)
+{
+    xSemaphoreTake(epd_session.lock, portMAX_DELAY);
+
+    if (epd_session.idle_timer) {
+        esp_timer_stop(epd_session.idle_timer);
+    }
+
+    if (!epd_session.powered) {
+        epd_session.power_on();
+        epd_session.powered = true;
+        epd_session.stats.power_ups++;
+    }
+}
+
+void epd_session_end(void)
+{
+    epd_session.stats.updates++;
+    epd_session.last_end_us = esp_timer_get_time();
+
+    if (epd_session.idle_timer) {
+        esp_timer_start_once(epd_session.idle_timer, epd_session.idle_timeout_us);
+    } else {
+        epd_session_power_down();
+    }
+
+    xSemaphoreGive(epd_session.lock);
+}
+
+void epd_session_close(void)
+{
+    xSemaphoreTake(epd_session.lock, portMAX_DELAY);
+
+    if (epd_session.idle_timer) {
+        esp_timer_stop(epd_session.idle_timer);
+    }
+    epd_session_power_down();
+
+    xSemaphoreGive(epd_session.lock);
+}
+
+void epd_session_add_busy_time(int64_t us)
+{
+    epd_session.stats.busy_time_us += us;
+}
+
+void epd_session_add_data_bytes(size_t len)
+{
+    epd_session.stats.data_bytes += len;
+}
+
+void epd_session_get_stats(epd_session_stats_t *stats)
+{
+    xSemaphoreTake(epd_session.lock, portMAX_DELAY);
+    *stats = epd_session.stats;
+    xSemaphoreGive(epd_session.lock);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/* Runs in the esp_timer task, only hands over to the idle task */
+static void epd_session_idle_cb(void *arg)
+{
+    (void) arg;
+
+    xTaskNotifyGive(epd_session.idle_task);
+}
+
+static void epd_session_idle_task(void *arg)
+{
+    (void) arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(epd_session.lock, portMAX_DELAY);
+
+        /* An update may have ended (and re-armed the timer) while this task
+         * was waiting for the lock */
+        if ((esp_timer_get_time() - epd_session.last_end_us) >= (int64_t) epd_session.idle_timeout_us) {
+            epd_session_power_down();
+        }
+
+        xSemaphoreGive(epd_session.lock);
+    }
+}
+
+static void epd_session_power_down(void)
+{
+    if (!epd_session.powered) {
+        return;
+    }
+
+    epd_session.power_off();
+    epd_session.powered = false;
+
+    LV_LOG_INFO("Panel powered down, %u power ups, %u updates, %u ms busy, %u KiB frame data",
+                epd_session.stats.power_ups, epd_session.stats.updates,
+                (uint32_t) (epd_session.stats.busy_time_us / 1000),
+                (uint32_t) (epd_session.stats.data_bytes / 1024));
+}
@@ -0,0 +1,99 @@
+/**
+ * @file epd_session.h
+ *
+ * Power session shared by the e-paper display drivers: keeps the panel
+ * powered while updates keep coming and powers it down once it was idle
+ * for a while.
+ */
+
+#ifndef EPD_SESSION_H
+#define EPD_SESSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * @brief Panel power callback, called with the session lock held
+ */
+typedef void (*epd_session_power_cb_t)(void);
+
+typedef struct {
+    uint32_t power_ups;         /* Times the panel was powered up */
+    uint32_t updates;           /* Updates drawn */
+    uint64_t data_bytes;        /* Frame data sent to the panel, OLD and NEW planes */
+    uint64_t busy_time_us;      /* Time spent waiting for the BUSY signal */
+} epd_session_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Initialise the power session
+ *
+ * The panel is considered powered down until the first update.
+ *
+ * @param power_on        Powers the panel up (and loads whatever the driver needs loaded)
+ * @param power_off       Powers the panel down
+ * @param idle_timeout_ms Idle time before the panel is powered down, 0 powers it down after every update
+ * @return                true on success
+ */
+bool epd_session_init(epd_session_power_cb_t power_on, epd_session_power_cb_t power_off, uint32_t idle_timeout_ms);
+
+/**
+ * @brief Start an update, powering the panel up if needed
+ *
+ * Holds the session lock until epd_session_end(), calls don't nest.
+ */
+void epd_session_begin(void);
+
+/**
+ * @brief Finish an update and start counting idle time
+ */
+void epd_session_end(void);
+
+/**
+ * @brief Power the panel down right away if it is powered
+ *
+ * Call before putting the panel into deep sleep.
+ */
+void epd_session_close(void);
+
+/**
+ * @brief Account time spent waiting for the BUSY signal
+ *
+ * @param us Time in microseconds
+ */
+void epd_session_add_busy_time(int64_t us);
+
+/**
+ * @brief Account frame data sent to the panel
+ *
+ * @param len Bytes sent
+ */
+void epd_session_add_data_bytes(size_t len);
+
+/**
+ * @brief Get the session counters
+ *
+ * @param stats Filled with the counters since initialisation
+ */
+void epd_session_get_stats(epd_session_stats_t *stats);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* EPD_SESSION_H */
@@ -0,0 +1,208 @@
+/**
+ * @file epd_worker.c
+ *
+ * A full e-paper refresh blocks for hundreds of milliseconds (seconds on some
+ * panels) waiting for the BUSY signal. Running it from the LVGL flush callback
+ * stalls LVGL for that long, so the e-paper drivers can hand their frames over
+ * to this task instead.
+ *
+ * The hand over is a single slot mailbox: the flush callback copies the frame
+ * into the pending slot and returns, the task swaps the pending and active
+ * slots and refreshes the panel from the active one. Frames arriving while a
+ * refresh is in progress overwrite the pending slot, so a burst of LVGL
+ * updates ends up as a single panel refresh showing the latest frame.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <esp_heap_caps.h>
+
+#ifdef LV_LVGL_H_INCLUDE_SIMPLE
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+#include "sdkconfig.h"
+#include "epd_worker.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#if defined (CONFIG_LV_EPD_REFRESH_TASK_PRIORITY)
+#define EPD_WORKER_TASK_PRIORITY    CONFIG_LV_EPD_REFRESH_TASK_PRIORITY
+#else
+#define EPD_WORKER_TASK_PRIORITY    5
+#endif
+
+#if defined (CONFIG_LV_EPD_REFRESH_TASK_STACK_SIZE)
+#define EPD_WORKER_TASK_STACK_SIZE  CONFIG_LV_EPD_REFRESH_TASK_STACK_SIZE
+#else
+#define EPD_WORKER_TASK_STACK_SIZE  3072
+#endif
+
+/* Polling period used while waiting for the worker to become idle */
+#define EPD_WORKER_IDLE_POLL_MS     10
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    SemaphoreHandle_t lock;
+    TaskHandle_t task;
+    epd_worker_refresh_cb_t refresh_cb;
+    uint8_t *pending;       /* Latest frame, not picked up yet */
+    uint8_t *active;        /* Frame being drawn on the panel */
+    size_t fb_len;
+    bool has_pending;
+    bool busy;
+    uint32_t dropped;       /* Frames replaced before they were drawn */
+} epd_worker_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void epd_worker_task(void *arg);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static epd_worker_t epd_worker;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+bool epd_worker_init(size_t fb_len, epd_worker_refresh_cb_t refresh_cb)
+{
+    assert(refresh_cb != NULL);
+
+    if (epd_worker.task != NULL) {
+        return true;
+    }
+
+    epd_worker.lock = xSemaphoreCreateMutex();
+    /* Both slots are handed to the SPI driver, so they must be DMA capable */
+    epd_worker.pending = heap_caps_malloc(fb_len, MALLOC_CAP_DMA);
+    epd_worker.active = heap_caps_malloc(fb_len, MALLOC_CAP_DMA);
+
+    if (!epd_worker.lock || !epd_worker.pending || !epd_worker.active) {
+        LV_LOG_ERROR("Failed to allocate the refresh mailbox (%u bytes per slot)", fb_len);
+        goto err;
+    }
+
+    epd_worker.fb_len = fb_len;
+    epd_worker.refresh_cb = refresh_cb;
+    epd_worker.has_pending = false;
+    epd_worker.busy = false;
+    epd_worker.dropped = 0;
+
+    if (xTaskCreate(epd_worker_task, "epd_refresh", EPD_WORKER_TASK_STACK_SIZE,
+                    NULL, EPD_WORKER_TASK_PRIORITY, &epd_worker.task) != pdPASS) {
+        LV_LOG_ERROR("Failed to create the refresh task");
+        epd_worker.task = NULL;
+        goto err;
+    }
+
+    return true;
+
+err:
+    if (epd_worker.lock) {
+        vSemaphoreDelete(epd_worker.lock);
+        epd_worker.lock = NULL;
+    }
+    heap_caps_free(epd_worker.pending);
+    heap_caps_free(epd_worker.active);
+    epd_worker.pending = NULL;
+    epd_worker.active = NULL;
+
+    return false;
+}
+
+bool epd_worker_submit(const uint8_t *fb)
+{
+    if (epd_worker.task == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(epd_worker.lock, portMAX_DELAY);
+
+    if (epd_worker.has_pending) {
+        epd_worker.dropped++;
+        LV_LOG_INFO("Coalescing frame, %u frames skipped so far", epd_worker.dropped);
+    }
+
+    memcpy(epd_worker.pending, fb, epd_worker.fb_len);
+    epd_worker.has_pending = true;
+
+    xSemaphoreGive(epd_worker.lock);
+
+    xTaskNotifyGive(epd_worker.task);
+
+    return true;
+}
+
+bool epd_worker_wait_idle(uint32_t timeout_ms)
+{
+    if (epd_worker.task == NULL) {
+        return true;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+
+    for (;;) {
+        xSemaphoreTake(epd_worker.lock, portMAX_DELAY);
+        bool idle = !epd_worker.has_pending && !epd_worker.busy;
+        xSemaphoreGive(epd_worker.lock);
+
+        if (idle) {
+            return true;
+        }
+
+        if ((timeout_ms != 0) && ((xTaskGetTickCount() - start) >= timeout)) {
+            return false;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(EPD_WORKER_IDLE_POLL_MS));
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static void epd_worker_task(void *arg)
+{
+    (void) arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        /* Keep going until the mailbox is empty, frames submitted during a
+         * refresh don't leave a notification behind once they are consumed */
+        for (;;) {
+            xSemaphoreTake(epd_worker.lock, portMAX_DELAY);
+
+            if (!epd_worker.has_pending) {
+                epd_worker.busy = false;
+                xSemaphoreGive(epd_worker.lock);
+                break;
+            }
+
+            uint8_t *fb = epd_worker.pending;
+            epd_worker.pending = epd_worker.active;
+            epd_worker.active = fb;
+            epd_worker.has_pending = false;
+            epd_worker.busy = true;
+
+            xSemaphoreGive(epd_worker.lock);
+
+            epd_worker.refresh_cb(fb, epd_worker.fb_len);
+        }
+    }
+}
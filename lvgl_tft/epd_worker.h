@@ -0,0 +1,78 @@
+/**
+ * @file epd_worker.h
+ *
+ * Background refresh task shared by the e-paper display drivers.
+ */
+
+#ifndef EPD_WORKER_H
+#define EPD_WORKER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**
+ * @brief Refresh callback, runs in the context of the refresh task
+ *
+ * @param fb  Full panel framebuffer, owned by the worker until the callback returns
+ * @param len Framebuffer length in bytes
+ */
+typedef void (*epd_worker_refresh_cb_t)(uint8_t *fb, size_t len);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Start the refresh task
+ *
+ * Allocates the two DMA capable frame slots (the one being refreshed and the
+ * latest frame waiting for it) and creates the refresh task.
+ *
+ * @param fb_len     Size in bytes of a full panel framebuffer
+ * @param refresh_cb Driver function performing a synchronous panel refresh
+ * @return           true on success
+ */
+bool epd_worker_init(size_t fb_len, epd_worker_refresh_cb_t refresh_cb);
+
+/**
+ * @brief Hand a frame over to the refresh task
+ *
+ * The frame is copied into the mailbox slot and the function returns right
+ * away, so the caller can signal flush ready to LVGL. A frame submitted while
+ * a previous one is still waiting replaces it, only the latest frame is
+ * ever drawn on the panel.
+ *
+ * @param fb Full panel framebuffer, fb_len bytes long
+ * @return   false if the refresh task is not running (epd_worker_init failed),
+ *           the caller has to refresh the panel itself
+ */
+bool epd_worker_submit(const uint8_t *fb);
+
+/**
+ * @brief Wait until all submitted frames have been drawn
+ *
+ * Call before sending commands to the panel outside of the refresh task,
+ * e.g. before putting it into deep sleep.
+ *
+ * @param timeout_ms Timeout in milliseconds, 0 waits forever
+ * @return           true when the worker is idle
+ */
+bool epd_worker_wait_idle(uint32_t timeout_ms);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* EPD_WORKER_H */
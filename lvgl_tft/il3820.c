@@ -33,6 +33,8 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "epd_worker.h"
+#include "epd_greyscale.h"
 #include "il3820.h"
 
 /*********************
@@ -62,6 +64,10 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 
 #define IL3820_PIXELS_PER_BYTE		8
 
+/* Size of the LVGL framebuffer, in bytes */
+#define IL3820_FB_LEN                   (IL3820_COLUMNS * EPD_PANEL_HEIGHT)
+#define IL3820_LV_FB_LEN                (IL3820_FB_LEN * EPD_BITS_PER_PIXEL)
+
 uint8_t il3820_scan_mode = IL3820_DATA_ENTRY_XIYIY;
 
 static uint8_t il3820_lut_initial[] = {
@@ -78,6 +84,20 @@ static uint8_t il3820_lut_default[] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 };
 
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+/* 4 level greyscale: the RED RAM holds the LSB and the RAM the MSB of each
+ * pixel, so the transition index picks one waveform per grey level.
+ * After a black/white reset the darker levels get more black phases. */
+static uint8_t il3820_lut_grey[] = {
+    0x55, 0xAA, 0x15, 0x11, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0x44, 0x04, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static epd_grey_planes_t il3820_grey;
+#endif
+
 static uint8_t il3820_softstart[] = {0xd7, 0xd6, 0x9d};
 static uint8_t il3820_vcom[] = {0xa8};
 /* 4 dummy lines per gate */
@@ -88,12 +108,16 @@ static uint8_t il3820_border[] = {0x03};
 
 static bool il3820_partial = false;
 
+/* LUT resident in the controller, NULL after a reset */
+static const uint8_t *il3820_resident_lut = NULL;
+
 /* Static functions */
 static void il3820_clear_cntlr_mem(uint8_t ram_cmd, bool update);
 static void il3820_waitbusy(int wait_ms);
 static inline void il3820_command_mode(void);
 static inline void il3820_data_mode(void);
 static inline void il3820_write_cmd(uint8_t cmd, uint8_t *data, size_t len);
+static void il3820_load_lut(uint8_t *lut, size_t len);
 static inline void il3820_send_cmd(uint8_t cmd);
 static void il3820_send_data(uint8_t *data, uint16_t length);
 static inline void il3820_set_window( uint16_t sx, uint16_t ex, uint16_t ys, uint16_t ye);
@@ -101,15 +125,54 @@ static inline void il3820_set_cursor(uint16_t sx, uint16_t ys);
 static void il3820_update_display(void);
 static void il3820_clear_cntlr_mem(uint8_t ram_cmd, bool update);
 static void il3820_reset(void);
+static void il3820_refresh(uint8_t *buffer, size_t len);
+static void il3820_write_ram(uint8_t ram_cmd, const uint8_t *buffer);
 
 /* Required by LVGL */
 void il3820_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+#if defined (CONFIG_LV_EPD_BACKGROUND_REFRESH)
+    /* The frame is copied, LVGL can render the next one while the
+     * panel refreshes, or drawn here if the refresh task did not start */
+    if (!epd_worker_submit((uint8_t *) color_map)) {
+        il3820_refresh((uint8_t *) color_map, IL3820_LV_FB_LEN);
+    }
+#else
+    il3820_refresh((uint8_t *) color_map, IL3820_LV_FB_LEN);
+#endif
+
+    /* IMPORTANT!!!
+     * Inform the graphics library that you are ready with the flushing */
+    lv_disp_flush_ready(drv);
+}
+
+/* Write the framebuffer into the controller graphic RAM and update the
+ * display, called from the flush callback or from the refresh task. */
+static void il3820_refresh(uint8_t *buffer, size_t len)
+{
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    /* The grey waveform replaces the default LUT until the next frame */
+    epd_grey_split(&il3820_grey, buffer);
+
+    il3820_load_lut(il3820_lut_grey, sizeof(il3820_lut_grey));
+    il3820_write_ram(IL3820_CMD_WRITE_RED_RAM, il3820_grey.lsb);
+    il3820_write_ram(IL3820_CMD_WRITE_RAM, il3820_grey.msb);
+#else
+    il3820_write_ram(IL3820_CMD_WRITE_RAM, buffer);
+#endif
+
+    il3820_set_window(0, EPD_PANEL_WIDTH - 1, 0, EPD_PANEL_HEIGHT - 1);
+
+    il3820_update_display();
+}
+
+/* Write a 1 bit per pixel frame into one of the controller RAMs */
+static void il3820_write_ram(uint8_t ram_cmd, const uint8_t *buffer)
 {
     /* Each byte holds the data of 8 pixels, linelen is the number of bytes
      * we need to cover a line of the display. */
     size_t linelen = EPD_PANEL_WIDTH / 8;
 
-    uint8_t *buffer = (uint8_t*) color_map;
     uint16_t x_addr_counter = 0;
     uint16_t y_addr_counter = 0;
 
@@ -129,21 +192,13 @@ void il3820_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_m
 
     il3820_set_cursor(x_addr_counter, y_addr_counter);
 
-    il3820_send_cmd(IL3820_CMD_WRITE_RAM);
+    il3820_send_cmd(ram_cmd);
 
     /* Write the pixel data to graphic RAM, linelen bytes at the time. */
     for(size_t row = 0; row <= (EPD_PANEL_HEIGHT - 1); row++){
-	il3820_send_data(buffer, linelen);
+	il3820_send_data((uint8_t *) buffer, linelen);
 	buffer += IL3820_COLUMNS;
     }
-
-    il3820_set_window(0, EPD_PANEL_WIDTH - 1, 0, EPD_PANEL_HEIGHT - 1);
-
-    il3820_update_display();
-
-    /* IMPORTANT!!!
-     * Inform the graphics library that you are ready with the flushing */
-    lv_disp_flush_ready(drv);
 }
 
 
@@ -160,24 +215,35 @@ void il3820_set_px_cb(lv_disp_drv_t * disp_drv, uint8_t* buf,
     uint8_t  bit_index = 0;
 
 #if defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT)
-    byte_index = x + ((y >> 3) * EPD_PANEL_HEIGHT);
     bit_index  = y & 0x7;
 
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    /* Every level is stored at the mirrored position */
+    byte_index = (EPD_PANEL_HEIGHT - 1 - x) + ((y >> 3) * EPD_PANEL_HEIGHT);
+    epd_grey_set_px(buf, byte_index, bit_index, epd_grey_level(color));
+#else
+    byte_index = x + ((y >> 3) * EPD_PANEL_HEIGHT);
+
     if (color.full) {
         BIT_SET(buf[byte_index], 7 - bit_index);
     } else {
         uint16_t mirrored_idx = (EPD_PANEL_HEIGHT - x) + ((y >> 3) * EPD_PANEL_HEIGHT);
         BIT_CLEAR(buf[mirrored_idx], 7 - bit_index);
     }
+#endif
 #elif defined (CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE)
     byte_index = y + ((x >> 3) * EPD_PANEL_HEIGHT);
     bit_index  = x & 0x7;
 
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    epd_grey_set_px(buf, byte_index, bit_index, epd_grey_level(color));
+#else
     if (color.full) {
         BIT_SET(buf[byte_index], 7 - bit_index);
     } else {
         BIT_CLEAR(buf[byte_index], 7 - bit_index);
     }
+#endif
 #else
     (void)byte_index;
     (void)bit_index;
@@ -196,6 +262,13 @@ void il3820_init(void)
 {
     uint8_t tmp[3] = {0};
 
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    /* LVGL renders 2 bpp frames, they cannot be sent without the planes */
+    if (!epd_grey_planes_init(&il3820_grey, IL3820_FB_LEN)) {
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+#endif
+
     il3820_reset();
 
     /* Busy wait for the BUSY signal to go low */
@@ -219,7 +292,7 @@ void il3820_init(void)
     /* Select border waveform for VBD */
     il3820_write_cmd(IL3820_CMD_BWF_CTRL, il3820_border, 1);
     /**/
-    il3820_write_cmd(IL3820_CMD_UPDATE_LUT, il3820_lut_initial, sizeof(il3820_lut_initial));
+    il3820_load_lut(il3820_lut_initial, sizeof(il3820_lut_initial));
     /* Clear control memory and update */
     il3820_clear_cntlr_mem(IL3820_CMD_WRITE_RAM, true);
 
@@ -227,10 +300,16 @@ void il3820_init(void)
     il3820_partial = true;
 
     /* Update LUT */
-    il3820_write_cmd(IL3820_CMD_UPDATE_LUT, il3820_lut_default, sizeof(il3820_lut_default));
+    il3820_load_lut(il3820_lut_default, sizeof(il3820_lut_default));
 
     /* Clear control memory and update */
     il3820_clear_cntlr_mem(IL3820_CMD_WRITE_RAM, true);
+
+#if defined (CONFIG_LV_EPD_BACKGROUND_REFRESH)
+    if (!epd_worker_init(IL3820_LV_FB_LEN, il3820_refresh)) {
+        LV_LOG_ERROR("Failed to start the refresh task");
+    }
+#endif
 }
 
 /* Enter deep sleep mode */
@@ -238,6 +317,11 @@ void il3820_sleep_in(void)
 {
     uint8_t data[] = {0x01};
 
+#if defined (CONFIG_LV_EPD_BACKGROUND_REFRESH)
+    /* Let the refresh task finish drawing the last frame first */
+    epd_worker_wait_idle(0);
+#endif
+
     /* Wait for the BUSY signal to go low */
     il3820_waitbusy(IL3820_WAIT);
 
@@ -296,13 +380,32 @@ static inline void il3820_send_cmd(uint8_t cmd)
     disp_spi_send_data(&cmd, 1);
 }
 
-/* Send length bytes of data to the display */
+/* Send length bytes of data to the display
+ *
+ * Queued without signalling flush ready, il3820_flush does that once the
+ * whole frame is out and the refresh task must never signal it at all.
+ * Consecutive rows stay queued behind each other, the wait for them is in
+ * il3820_send_cmd and il3820_write_cmd, before DC goes back to command mode. */
 static void il3820_send_data(uint8_t *data, uint16_t length)
 {
-    disp_wait_for_pending_transactions();
-
     il3820_data_mode();
-    disp_spi_send_colors(data, length);
+    disp_spi_transaction(data, length, DISP_SPI_SEND_QUEUED, NULL, 0, 0);
+}
+
+/* Upload a LUT unless it is the one already loaded
+ *
+ * The LUT goes out as a single queued transaction, the LUT arrays live in
+ * DRAM so they can be handed to the DMA directly. */
+static void il3820_load_lut(uint8_t *lut, size_t len)
+{
+    if (il3820_resident_lut == lut) {
+        return;
+    }
+
+    il3820_send_cmd(IL3820_CMD_UPDATE_LUT);
+    il3820_send_data(lut, len);
+
+    il3820_resident_lut = lut;
 }
 
 /* Specify the start/end positions of the window address in the X and Y
@@ -377,21 +480,19 @@ static void il3820_update_display(void)
 /* Clear the graphic RAM. */
 static void il3820_clear_cntlr_mem(uint8_t ram_cmd, bool update)
 {
-    /* Arrays used by SPI must be word alligned */
-    WORD_ALIGNED_ATTR uint8_t clear_page[IL3820_COLUMNS];
-    memset(clear_page, 0xff, sizeof clear_page);
-
     /* Configure entry mode */
     il3820_write_cmd(IL3820_CMD_ENTRY_MODE, &il3820_scan_mode, 1);
 
     /* Configure the window */
     il3820_set_window(0, EPD_PANEL_WIDTH - 1, 0, EPD_PANEL_HEIGHT - 1);
 
-    /* Send clear_page buffer to the display */
-    for(int j = 0; j < EPD_PANEL_HEIGHT; j++) {
-	il3820_set_cursor(0, j);
-	il3820_write_cmd(ram_cmd, clear_page, sizeof clear_page);
-    }
+    /* The address counter wraps around inside the window, so the whole
+     * RAM is cleared in a single write starting at the first row. */
+    il3820_set_cursor(0, 0);
+    il3820_send_cmd(ram_cmd);
+
+    il3820_data_mode();
+    disp_spi_send_fill(0xff, IL3820_FB_LEN);
 
     if (update) {
 	il3820_set_window( 0, EPD_PANEL_WIDTH - 1, 0, EPD_PANEL_HEIGHT - 1);
@@ -411,4 +512,5 @@ static void il3820_reset(void)
 
     /* Software reset */
     il3820_write_cmd(IL3820_CMD_SW_RESET, NULL, 0);
+    il3820_resident_lut = NULL;
 }
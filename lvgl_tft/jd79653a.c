@@ -29,8 +29,14 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
 #include <driver/gpio.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 
 #include "disp_spi.h"
+#include "epd_worker.h"
+#include "epd_refresh_policy.h"
+#include "epd_session.h"
+#include "epd_greyscale.h"
 #include "jd79653a.h"
 
 #define PIN_DC              CONFIG_LV_DISP_PIN_DC
@@ -60,14 +66,57 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 #endif
 
 #define EPD_ROW_LEN         (EPD_HEIGHT / 8u)
+#define EPD_FB_LEN          ((EPD_HEIGHT * EPD_WIDTH) / 8u)
+// Size of the LVGL framebuffer, two bytes per mono byte in greyscale mode
+#define EPD_LV_FB_LEN       (EPD_FB_LEN * EPD_BITS_PER_PIXEL)
+
+// Most partial refreshes between two full refreshes, 0 always refreshes in full
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+#define EPD_PARTIAL_CNT     0
+#elif defined (CONFIG_LV_EPD_PARTIAL_REFRESH_COUNT)
+#define EPD_PARTIAL_CNT     CONFIG_LV_EPD_PARTIAL_REFRESH_COUNT
+#else
+#define EPD_PARTIAL_CNT     5
+#endif
 
-/* ToDo Remove semicolon */
-#define EPD_PARTIAL_CNT     5;
+// Changed pixels a region takes before it gets a clean refresh, percent of its area
+#if defined (CONFIG_LV_EPD_GHOSTING_BUDGET)
+#define EPD_GHOSTING_BUDGET CONFIG_LV_EPD_GHOSTING_BUDGET
+#else
+#define EPD_GHOSTING_BUDGET 150
+#endif
+
+// Idle time before the panel is powered down, 0 powers it down after every update
+#if defined (CONFIG_LV_EPD_IDLE_POWER_DOWN_MS)
+#define EPD_IDLE_POWER_DOWN_MS  CONFIG_LV_EPD_IDLE_POWER_DOWN_MS
+#else
+#define EPD_IDLE_POWER_DOWN_MS  1000
+#endif
 
 #define BIT_SET(a, b)       ((a) |= (1U << (b)))
 #define BIT_CLEAR(a, b)     ((a) &= ~(1U << (b)))
 
-static uint8_t partial_counter = 0;
+// Frame currently shown on the panel, diffed against new frames to find the partial window
+static uint8_t *jd79653a_prev_fb = NULL;
+static bool jd79653a_prev_fb_valid = false;
+
+static epd_refresh_policy_t jd79653a_policy;
+
+// Partial mode entered and partial LUT loaded, kept that way between partial updates
+static bool jd79653a_partial_mode = false;
+
+typedef enum {
+    JD79653A_LUT_NONE,      // Nothing loaded since reset, or lost in deep sleep
+    JD79653A_LUT_PARTIAL,
+    JD79653A_LUT_GREY,
+} jd79653a_lut_t;
+
+// LUT set resident in the LUT registers, they keep it across power off and partial in/out
+static jd79653a_lut_t jd79653a_resident_lut = JD79653A_LUT_NONE;
+
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+static epd_grey_planes_t jd79653a_grey;
+#endif
 
 typedef struct
 {
@@ -78,7 +127,7 @@ typedef struct
 
 #define EPD_SEQ_LEN(x) ((sizeof(x) / sizeof(jd79653a_seq_t)))
 
-static const uint8_t lut_vcom_dc1[] = {
+static uint8_t lut_vcom_dc1[] = {
     0x01, 0x04, 0x04, 0x03, 0x01, 0x01, 0x01,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -90,7 +139,7 @@ static const uint8_t lut_vcom_dc1[] = {
 };
 
 
-static const uint8_t lut_ww1[] = {
+static uint8_t lut_ww1[] = {
     0x01, 0x04, 0x04, 0x03, 0x01, 0x01, 0x01,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -100,7 +149,7 @@ static const uint8_t lut_ww1[] = {
 };
 
 
-static const uint8_t lut_bw1[] = {
+static uint8_t lut_bw1[] = {
     0x01, 0x84, 0x84, 0x83, 0x01, 0x01, 0x01,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -112,7 +161,7 @@ static const uint8_t lut_bw1[] = {
 };
 
 
-static const uint8_t lut_wb1[] = {
+static uint8_t lut_wb1[] = {
     0x01, 0x44, 0x44, 0x43, 0x01, 0x01, 0x01,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -124,7 +173,7 @@ static const uint8_t lut_wb1[] = {
 };
 
 
-static const uint8_t lut_bb1[] = {
+static uint8_t lut_bb1[] = {
     0x01, 0x04, 0x04, 0x03, 0x01, 0x01, 0x01,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -135,6 +184,71 @@ static const uint8_t lut_bb1[] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 };
 
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+/*
+ * 4 level greyscale waveform, same layout as the partial LUTs. The OLD/NEW
+ * data pair selects the LUT: the first group drives every pixel black then
+ * white to clean the panel, the second one drives the pixel back towards
+ * black for a time depending on its grey level.
+ */
+static uint8_t lut_vcom_grey[] = {
+    0x01, 0x0a, 0x0a, 0x00, 0x00, 0x01, 0x01,
+    0x01, 0x08, 0x00, 0x00, 0x00, 0x01, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// OLD 1, NEW 1: white
+static uint8_t lut_ww_grey[] = {
+    0x01, 0x4a, 0x8a, 0x00, 0x00, 0x01, 0x01,
+    0x01, 0x08, 0x00, 0x00, 0x00, 0x01, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// OLD 0, NEW 1: light grey
+static uint8_t lut_bw_grey[] = {
+    0x01, 0x4a, 0x8a, 0x00, 0x00, 0x01, 0x01,
+    0x01, 0x42, 0x06, 0x00, 0x00, 0x01, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// OLD 1, NEW 0: dark grey
+static uint8_t lut_wb_grey[] = {
+    0x01, 0x4a, 0x8a, 0x00, 0x00, 0x01, 0x01,
+    0x01, 0x44, 0x04, 0x00, 0x00, 0x01, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// OLD 0, NEW 0: black
+static uint8_t lut_bb_grey[] = {
+    0x01, 0x4a, 0x8a, 0x00, 0x00, 0x01, 0x01,
+    0x01, 0x48, 0x00, 0x00, 0x00, 0x01, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+#endif
+
 
 static const jd79653a_seq_t init_seq[] = {
 #if defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT_INVERTED)
@@ -191,6 +305,20 @@ static void jd79653a_spi_send_data(uint8_t *data, size_t len)
     disp_spi_send_data(data, len);
 }
 
+// Queue data without draining the queue first, the buffer must stay untouched until the next command is sent
+static void jd79653a_spi_queue_data(uint8_t *data, size_t len)
+{
+    gpio_set_level(PIN_DC, 1);  // DC = 1 for data, only data transactions can be in flight here
+    disp_spi_transaction(data, len, DISP_SPI_SEND_QUEUED, NULL, 0, 0);
+}
+
+static void jd79653a_spi_fill_data(uint8_t pattern, size_t len)
+{
+    disp_wait_for_pending_transactions();
+    gpio_set_level(PIN_DC, 1);  // DC = 1 for data
+    disp_spi_send_fill(pattern, len);
+}
+
 static void jd79653a_spi_send_seq(const jd79653a_seq_t *seq, size_t len)
 {
     LV_LOG_INFO("Writing cmd/data sequence, count %u", len);
@@ -207,10 +335,12 @@ static void jd79653a_spi_send_seq(const jd79653a_seq_t *seq, size_t len)
 static esp_err_t jd79653a_wait_busy(uint32_t timeout_ms)
 {
     uint32_t wait_ticks = (timeout_ms == 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms));
+    int64_t start = esp_timer_get_time();
     EventBits_t bits = xEventGroupWaitBits(jd79653a_evts,
                                            EVT_BUSY, // Wait for busy bit
                                            pdTRUE, pdTRUE,       // Clear on exit, wait for all
                                            wait_ticks);         // Timeout
+    epd_session_add_busy_time(esp_timer_get_time() - start);
 
     return ((bits & EVT_BUSY) != 0) ? ESP_OK : ESP_ERR_TIMEOUT;
 }
@@ -222,30 +352,59 @@ static void jd79653a_power_on(void)
     jd79653a_wait_busy(0);
 }
 
+static void jd79653a_partial_out(void);
+
 static void jd79653a_power_off(void)
 {
+    if (jd79653a_partial_mode) {
+        jd79653a_partial_out();
+    }
+
     jd79653a_spi_send_seq(power_off_seq, EPD_SEQ_LEN(power_off_seq));
     vTaskDelay(pdMS_TO_TICKS(10));
     jd79653a_wait_busy(0);
 }
 
+// Each LUT goes out as a single queued transaction, the next command waits for it.
+// The DMA reads the lut_* tables in place, which is why they are not const.
+static void jd79653a_send_lut(uint8_t reg, uint8_t *lut, size_t len)
+{
+    jd79653a_spi_send_cmd(reg);
+    jd79653a_spi_queue_data(lut, len);
+}
+
 static void jd79653a_load_partial_lut(void)
 {
-    jd79653a_spi_send_cmd(0x20); // LUT VCOM register
-    jd79653a_spi_send_data((uint8_t *)lut_vcom_dc1, sizeof(lut_vcom_dc1));
+    if (jd79653a_resident_lut == JD79653A_LUT_PARTIAL) {
+        LV_LOG_INFO("Partial LUT already loaded");
+        return;
+    }
 
-    jd79653a_spi_send_cmd(0x21); // LUT White-to-White
-    jd79653a_spi_send_data((uint8_t *)lut_ww1, sizeof(lut_ww1));
+    jd79653a_send_lut(0x20, lut_vcom_dc1, sizeof(lut_vcom_dc1));   // LUT VCOM register
+    jd79653a_send_lut(0x21, lut_ww1, sizeof(lut_ww1));             // LUT White-to-White
+    jd79653a_send_lut(0x22, lut_bw1, sizeof(lut_bw1));             // LUT Black-to-White
+    jd79653a_send_lut(0x23, lut_wb1, sizeof(lut_wb1));             // LUT White-to-Black
+    jd79653a_send_lut(0x24, lut_bb1, sizeof(lut_bb1));             // LUT Black-to-Black
 
-    jd79653a_spi_send_cmd(0x22); // LUT Black-to-White
-    jd79653a_spi_send_data((uint8_t *)lut_bw1, sizeof(lut_bw1));
+    jd79653a_resident_lut = JD79653A_LUT_PARTIAL;
+}
+
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+static void jd79653a_load_grey_lut(void)
+{
+    if (jd79653a_resident_lut == JD79653A_LUT_GREY) {
+        return;
+    }
 
-    jd79653a_spi_send_cmd(0x23); // LUT White-to-Black
-    jd79653a_spi_send_data((uint8_t *)lut_wb1,sizeof(lut_wb1));
+    jd79653a_send_lut(0x20, lut_vcom_grey, sizeof(lut_vcom_grey));
+    jd79653a_send_lut(0x21, lut_ww_grey, sizeof(lut_ww_grey));
+    jd79653a_send_lut(0x22, lut_bw_grey, sizeof(lut_bw_grey));
+    jd79653a_send_lut(0x23, lut_wb_grey, sizeof(lut_wb_grey));
+    jd79653a_send_lut(0x24, lut_bb_grey, sizeof(lut_bb_grey));
 
-    jd79653a_spi_send_cmd(0x24); // LUT Black-to-Black
-    jd79653a_spi_send_data((uint8_t *)lut_bb1, sizeof(lut_bb1));
+    jd79653a_resident_lut = JD79653A_LUT_GREY;
 }
+#endif
 
 static void jd79653a_partial_in(void)
 {
@@ -273,6 +432,7 @@ static void jd79653a_partial_in(void)
 
     // Go partial!
     jd79653a_spi_send_cmd(0x91);
+    jd79653a_partial_mode = true;
 }
 
 static void jd79653a_partial_out(void)
@@ -298,30 +458,69 @@ static void jd79653a_partial_out(void)
 
     // Out from partial!
     jd79653a_spi_send_cmd(0x92);
+    jd79653a_partial_mode = false;
+}
+
+static void jd79653a_remember_frame(const uint8_t *data)
+{
+    if (jd79653a_prev_fb) {
+        memcpy(jd79653a_prev_fb, data, EPD_FB_LEN);
+        jd79653a_prev_fb_valid = true;
+    }
+}
+
+// Queue the window content row by row, unless the window is as wide as the panel
+static void jd79653a_spi_queue_window(const uint8_t *fb, const lv_area_t *win)
+{
+    size_t win_row_len = (win->x2 - win->x1 + 1) / 8;
+    uint8_t *data_ptr = (uint8_t *) fb + (win->y1 * EPD_ROW_LEN) + (win->x1 / 8);
+
+    if (win_row_len == EPD_ROW_LEN) {
+        jd79653a_spi_queue_data(data_ptr, win_row_len * (win->y2 - win->y1 + 1));
+    } else {
+        for (lv_coord_t h_idx = win->y1; h_idx <= win->y2; h_idx++) {
+            jd79653a_spi_queue_data(data_ptr, win_row_len);
+            data_ptr += EPD_ROW_LEN;
+        }
+    }
 }
 
-static void jd79653a_update_partial(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t *data)
+/**
+ * Refresh a window of the panel. A clean refresh keeps the OTP waveform,
+ * which drives every pixel of the window and removes the ghosting left by
+ * previous partial refreshes, so it needs the OLD frame for the window too.
+ */
+static void jd79653a_update_window(const lv_area_t *win, uint8_t *data, bool clean)
 {
-    jd79653a_power_on();
-    jd79653a_partial_in();
-    LV_LOG_INFO("x1: 0x%x, x2: 0x%x, y1: 0x%x, y2: 0x%x", x1, x2, y1, y2);
+    epd_session_begin();
+    if (clean) {
+        // Clean refreshes use the OTP waveform, partial mode only limits them to the window
+        if (jd79653a_partial_mode) {
+            jd79653a_partial_out();
+        }
+        LV_LOG_INFO("Clean partial in!");
+        jd79653a_spi_send_cmd(0x91);
+    } else if (!jd79653a_partial_mode) {
+        jd79653a_partial_in();
+    }
+    LV_LOG_INFO("x1: 0x%x, x2: 0x%x, y1: 0x%x, y2: 0x%x", win->x1, win->x2, win->y1, win->y2);
 
-    size_t len = ((x2 - x1 + 1) * (y2 - y1 + 1)) / 8;
+    size_t len = ((win->x2 - win->x1 + 1) * (win->y2 - win->y1 + 1)) / 8;
     LV_LOG_INFO("Writing PARTIAL LVGL fb with len: %u", len);
+    epd_session_add_data_bytes(clean ? (2 * len) : len);
 
-    // Set partial window
-    uint8_t ptl_setting[7] = { x1, x2, 0, y1, 0, y2, 0x01 };
+    // Set partial window, x must be byte aligned
+    uint8_t ptl_setting[7] = { win->x1, win->x2, 0, win->y1, 0, win->y2, 0x01 };
     jd79653a_spi_send_cmd(0x90);
     jd79653a_spi_send_data(ptl_setting, sizeof(ptl_setting));
 
-    uint8_t *data_ptr = data;
+    if (clean) {
+        jd79653a_spi_send_cmd(0x10);
+        jd79653a_spi_queue_window(jd79653a_prev_fb, win);
+    }
 
     jd79653a_spi_send_cmd(0x13);
-    for (size_t h_idx = 0; h_idx < EPD_HEIGHT; h_idx++) {
-        jd79653a_spi_send_data(data_ptr, EPD_ROW_LEN);
-        data_ptr += EPD_ROW_LEN;
-        len -= EPD_ROW_LEN;
-    }
+    jd79653a_spi_queue_window(data, win);
 
     LV_LOG_INFO("Partial wait start");
 
@@ -329,122 +528,217 @@ static void jd79653a_update_partial(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t
     jd79653a_wait_busy(0);
 
     LV_LOG_INFO("Partial updated");
-    jd79653a_partial_out();
-    jd79653a_power_off();
+    if (clean) {
+        jd79653a_spi_send_cmd(0x92);
+    }
+    epd_session_end();
 }
 
 static void jd79653a_reset(void);
 
 void jd79653a_fb_set_full_color(uint8_t color)
 {
-    jd79653a_power_on();
-    uint8_t old_data[EPD_ROW_LEN];
-    memset(old_data, ~(color), EPD_ROW_LEN);
+    epd_session_begin();
+    if (jd79653a_partial_mode) {
+        jd79653a_partial_out();
+    }
 
     // Fill OLD data (maybe not necessary)
     jd79653a_spi_send_cmd(0x10);
-    for (size_t idx = 0; idx < EPD_HEIGHT; idx++) {
-        jd79653a_spi_send_data(old_data, EPD_ROW_LEN);
-    }
+    jd79653a_spi_fill_data(~color, EPD_FB_LEN);
 
     // Fill NEW data
     jd79653a_spi_send_cmd(0x13);
-    for (size_t h_idx = 0; h_idx < EPD_HEIGHT; h_idx++) {
-        for (size_t w_idx = 0; w_idx < EPD_ROW_LEN; w_idx++) {
-            jd79653a_spi_send_data(&color, sizeof(color));
-        }
-    }
+    jd79653a_spi_fill_data(color, EPD_FB_LEN);
 
     jd79653a_spi_send_cmd(0x12); // Issue refresh command
     vTaskDelay(pdMS_TO_TICKS(100));
     jd79653a_wait_busy(0);
 
-    jd79653a_power_off();
+    if (jd79653a_prev_fb) {
+        memset(jd79653a_prev_fb, color, EPD_FB_LEN);
+        jd79653a_prev_fb_valid = true;
+    }
+    epd_refresh_policy_mark_clean(&jd79653a_policy, NULL);
+
+    epd_session_end();
 }
 
 void jd79653a_fb_full_update(uint8_t *data, size_t len)
 {
-    jd79653a_power_on();
+    epd_session_begin();
+    if (jd79653a_partial_mode) {
+        jd79653a_partial_out();
+    }
     LV_LOG_INFO("Performing full update, len: %u", len);
 
-    uint8_t *data_ptr = data;
-
-    // Fill OLD data (maybe not necessary)
-    uint8_t old_data[EPD_ROW_LEN] = { 0 };
+    // OLD data is the frame on the panel, so the OTP waveform only drives the pixels that change
     jd79653a_spi_send_cmd(0x10);
-    for (size_t idx = 0; idx < EPD_HEIGHT; idx++) {
-        jd79653a_spi_send_data(old_data, EPD_ROW_LEN);
+    if (jd79653a_prev_fb_valid) {
+        jd79653a_spi_queue_data(jd79653a_prev_fb, EPD_FB_LEN);
+    } else {
+        jd79653a_spi_fill_data(0x00, EPD_FB_LEN);
     }
 
-    // Fill NEW data
+    // NEW data in one go
     jd79653a_spi_send_cmd(0x13);
-    for (size_t h_idx = 0; h_idx < EPD_HEIGHT; h_idx++) {
-        jd79653a_spi_send_data(data_ptr, EPD_ROW_LEN);
-        data_ptr += EPD_ROW_LEN;
-        len -= EPD_ROW_LEN;
-    }
+    jd79653a_spi_queue_data(data, EPD_FB_LEN);
 
-    LV_LOG_INFO("Rest len: %u", len);
+    epd_session_add_data_bytes(2 * EPD_FB_LEN);
 
     jd79653a_spi_send_cmd(0x12); // Issue refresh command
     vTaskDelay(pdMS_TO_TICKS(100));
     jd79653a_wait_busy(0);
 
-    jd79653a_power_off();
+    jd79653a_remember_frame(data);
+    epd_refresh_policy_mark_clean(&jd79653a_policy, NULL);
+
+    epd_session_end();
 }
 
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+/**
+ * Draw a 2 bits per pixel frame in a single refresh: the least significant
+ * bit plane goes in as OLD data, the most significant one as NEW data, and
+ * the greyscale LUT picks a waveform for each of the four combinations.
+ */
+static void jd79653a_grey_update(const uint8_t *buf)
+{
+    epd_grey_split(&jd79653a_grey, buf);
+
+    epd_session_begin();
+    if (jd79653a_partial_mode) {
+        jd79653a_partial_out();
+    }
+
+    // Panel setting: LUT from registers
+#if defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT_INVERTED)
+    uint8_t pst_use_reg_lut[] = { 0xf3, 0x0e };
+#else
+    uint8_t pst_use_reg_lut[] = { 0xff, 0x0e };
+#endif
+    jd79653a_spi_send_cmd(0x00);
+    jd79653a_spi_send_data(pst_use_reg_lut, sizeof(pst_use_reg_lut));
+
+    // Both OLD and NEW data select the waveform
+    uint8_t vcom = 0x97;
+    jd79653a_spi_send_cmd(0x50);
+    jd79653a_spi_send_data(&vcom, 1);
+
+    jd79653a_load_grey_lut();
+
+    jd79653a_spi_send_cmd(0x10);
+    jd79653a_spi_queue_data(jd79653a_grey.lsb, EPD_FB_LEN);
+
+    jd79653a_spi_send_cmd(0x13);
+    jd79653a_spi_queue_data(jd79653a_grey.msb, EPD_FB_LEN);
+
+    epd_session_add_data_bytes(2 * EPD_FB_LEN);
+
+    jd79653a_spi_send_cmd(0x12);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    jd79653a_wait_busy(0);
+
+    epd_session_end();
+}
+#endif
+
 void jd79653a_lv_set_fb_cb(lv_disp_drv_t *disp_drv, uint8_t *buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
                            lv_color_t color, lv_opa_t opa)
 {
     uint16_t byte_index = (x >> 3u) + (y * EPD_ROW_LEN);
     uint8_t bit_index = x & 0x07u;
 
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    epd_grey_set_px(buf, byte_index, bit_index, epd_grey_level(color));
+#else
     if (color.full) {
         BIT_SET(buf[byte_index], 7 - bit_index);
     } else {
         BIT_CLEAR(buf[byte_index], 7 - bit_index);
     }
+#endif
 }
 
 void jd79653a_lv_rounder_cb(lv_disp_drv_t *disp_drv, lv_area_t *area)
 {
-    // Always send full framebuffer if it's not in partial mode
+    // Always hand over the full framebuffer, the partial window is found by diffing it against the previous frame
     area->x1 = 0;
     area->y1 = 0;
     area->x2 = EPD_WIDTH - 1;
     area->y2 = EPD_HEIGHT - 1;
 }
 
+// Synchronous panel refresh, called from the flush callback or from the background refresh task
+static void jd79653a_refresh(uint8_t *buf, size_t len)
+{
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    // No partial waveform for grey levels, every frame is a full greyscale refresh
+    LV_LOG_INFO("Refreshing greyscale fb with len: %u", len);
+    jd79653a_grey_update(buf);
+#else
+    LV_LOG_INFO("Refreshing fb with len: %u, partials so far: %u", len, jd79653a_policy.partials);
+
+    const uint8_t *prev = jd79653a_prev_fb_valid ? jd79653a_prev_fb : NULL;
+    lv_area_t win;
+
+    switch (epd_refresh_policy_evaluate(&jd79653a_policy, prev, buf, &win)) {
+    case EPD_REFRESH_NONE:
+        LV_LOG_INFO("Frame unchanged, skipping refresh");
+        break;
+    case EPD_REFRESH_FULL:
+        LV_LOG_INFO("Refreshing in FULL");
+        jd79653a_fb_full_update(buf, len);
+        break;
+    case EPD_REFRESH_CLEAN:
+        jd79653a_update_window(&win, buf, true);
+        jd79653a_remember_frame(buf);
+        break;
+    default:
+        jd79653a_update_window(&win, buf, false);
+        jd79653a_remember_frame(buf);
+        break;
+    }
+#endif
+}
+
 void jd79653a_lv_fb_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
 #if LV_USE_LOG
     size_t len = ((area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1)) / 8;
     LV_LOG_INFO("x1: 0x%x, x2: 0x%x, y1: 0x%x, y2: 0x%x", area->x1, area->x2, area->y1, area->y2);
-    LV_LOG_INFO("Writing LVGL fb with len: %u, partial counter: %u", len, partial_counter);
+    LV_LOG_INFO("Writing LVGL fb with len: %u", len);
 #endif
 
     uint8_t *buf = (uint8_t *) color_map;
 
-    if (partial_counter == 0) {
-        LV_LOG_INFO("Refreshing in FULL");
-        jd79653a_fb_full_update(buf, ((EPD_HEIGHT * EPD_WIDTH) / 8));
-        partial_counter = EPD_PARTIAL_CNT; // Reset partial counter here
-    } else {
-        jd79653a_update_partial(area->x1, area->y1, area->x2, area->y2, buf);
-        partial_counter -= 1;   // ...or otherwise, decrease 1
+#if defined (CONFIG_LV_EPD_BACKGROUND_REFRESH)
+    // The frame is copied, LVGL can render the next one while the panel refreshes,
+    // or drawn here if the refresh task did not start
+    if (!epd_worker_submit(buf)) {
+        jd79653a_refresh(buf, EPD_LV_FB_LEN);
     }
+#else
+    jd79653a_refresh(buf, EPD_LV_FB_LEN);
+#endif
 
     lv_disp_flush_ready(drv);
 }
 
 void jd79653a_deep_sleep(void)
 {
-    jd79653a_spi_send_seq(power_off_seq, EPD_SEQ_LEN(power_off_seq));
-    jd79653a_wait_busy(1000);
+#if defined (CONFIG_LV_EPD_BACKGROUND_REFRESH)
+    // Let the refresh task finish drawing the last frame first
+    epd_worker_wait_idle(0);
+#endif
+
+    // Powers the panel off unless the idle timeout already did
+    epd_session_close();
 
     uint8_t check_code = 0xa5;
     jd79653a_spi_send_cmd(0x07);
     jd79653a_spi_send_data(&check_code, sizeof(check_code));
+    jd79653a_resident_lut = JD79653A_LUT_NONE;
 }
 
 void jd79653a_init(void)
@@ -468,6 +762,25 @@ void jd79653a_init(void)
     gpio_install_isr_service(0);
     gpio_isr_handler_add(PIN_BUSY, jd79653a_busy_intr, (void *) PIN_BUSY);
 
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    // LVGL renders 2 bpp frames, they cannot be sent without the planes
+    if (!epd_grey_planes_init(&jd79653a_grey, EPD_FB_LEN)) {
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+#endif
+
+    // Keep a copy of the displayed frame, full updates send it as OLD data and partial updates are diffed against it
+    if (!jd79653a_prev_fb) {
+        jd79653a_prev_fb = heap_caps_malloc(EPD_FB_LEN, MALLOC_CAP_DMA);
+        if (!jd79653a_prev_fb) {
+            LV_LOG_WARN("No memory for the previous frame, partial updates disabled and OLD data left blank");
+        }
+    }
+    jd79653a_prev_fb_valid = false;
+
+    epd_session_init(jd79653a_power_on, jd79653a_power_off, EPD_IDLE_POWER_DOWN_MS);
+    epd_refresh_policy_init(&jd79653a_policy, EPD_WIDTH, EPD_HEIGHT, EPD_GHOSTING_BUDGET, EPD_PARTIAL_CNT);
+
     jd79653a_reset();
 
     // Dump in initialise sequence
@@ -477,6 +790,12 @@ void jd79653a_init(void)
     // Check BUSY status here
     jd79653a_wait_busy(0);
 
+#if defined (CONFIG_LV_EPD_BACKGROUND_REFRESH)
+    if (!epd_worker_init(EPD_LV_FB_LEN, jd79653a_refresh)) {
+        LV_LOG_ERROR("Failed when starting the refresh task!");
+    }
+#endif
+
     LV_LOG_INFO("Panel is up!");
 }
 
@@ -489,4 +808,6 @@ static void jd79653a_reset(void)
     gpio_set_level(PIN_RST, 1);
     vTaskDelay(pdMS_TO_TICKS(120));
 #endif
+    jd79653a_resident_lut = JD79653A_LUT_NONE;
+    jd79653a_partial_mode = false;
 }
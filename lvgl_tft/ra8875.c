@@ -6,6 +6,8 @@
 /*********************
  *      INCLUDES
  *********************/
+#include <string.h>
+
 #include "ra8875.h"
 #include "disp_spi.h"
 #include "driver/gpio.h"
@@ -43,6 +45,33 @@
 #define VDIR_MASK (1 << 2)
 #define HDIR_MASK (1 << 3)
 
+#define SCREEN_WIDTH  ((HDWR_VAL + 1) * 8)
+#define SCREEN_HEIGHT (VDHR_VAL + 1)
+
+#define STSR_BTE_BUSY       (0x40)      // Status Register: BTE busy
+#define BECR0_BTE_START     (0x80)      // BECR0: start the BTE, reads back 1 while it is busy
+#define BECR1_SOLID_FILL    (0x0C)      // BECR1: solid fill with the foreground color
+#define BECR1_MOVE_POS      (0xC2)      // BECR1: move in positive direction, ROP = source
+#define BECR1_MOVE_NEG      (0xC3)      // BECR1: move in negative direction, ROP = source
+
+#define BTE_FILL_MIN_PIXELS 128         // smaller solid areas are sent as pixels, the BTE setup costs about as much
+#define BTE_WAIT_POLLS      16          // status polls before waiting for the BTE sleeps
+#define BTE_LAYER(layer)    ((unsigned int)(layer) << 15)   // layer bit of the BTE source and destination Y
+
+#define RA8875_DRAM_SIZE    (768UL * 1024UL)
+
+// Two layers take twice the display RAM, at 800x480 that only fits with 8 bit colors
+#if defined (CONFIG_LV_DISP_RA8875_DOUBLE_BUFFER) && ((SCREEN_WIDTH * SCREEN_HEIGHT * BYTES_PER_PIXEL * 2) <= RA8875_DRAM_SIZE)
+    #define RA8875_DOUBLE_BUFFER 1
+    #define DPCR_LAYERS (0x80)          // DPCR: two layers
+    #define DRAW_LAYER  back_layer      // layer flushes draw into
+    #define DIRTY_MAX   16              // areas tracked per frame, more are merged
+#else
+    #define RA8875_DOUBLE_BUFFER 0
+    #define DPCR_LAYERS (0x00)
+    #define DRAW_LAYER  0
+#endif
+
 #ifndef CONFIG_LV_TFT_DISPLAY_CONTROLLER_RA8875
     // Use this settings if there is no Kconfig settings defined
     #define SYSR_VAL (0x00)
@@ -134,10 +163,40 @@ static void ra8875_set_memory_write_cursor(unsigned int x, unsigned int y);
 static void ra8875_set_window(unsigned int xs, unsigned int xe, unsigned int ys, unsigned int ye);
 static void ra8875_send_buffer(uint8_t * data, size_t length, bool signal_flush);
 static void ra8875_reset(void);
+static uint8_t ra8875_read_status(void);
+static void ra8875_bte_start(uint8_t becr1, unsigned int sx, unsigned int sy, unsigned int x, unsigned int y, unsigned int w, unsigned int h);
+static void ra8875_bte_wait(void);
+static void ra8875_bte_start_fill(const lv_area_t * area, lv_color_t color);
+#if RA8875_DOUBLE_BUFFER
+static void ra8875_mark_dirty(const lv_area_t * area);
+static void ra8875_back_buffer_prepare(void);
+static void ra8875_back_buffer_flip(void);
+#endif
+#if defined (CONFIG_LV_DISP_RA8875_BTE_FILL)
+static bool ra8875_area_is_solid(const lv_color_t * color_map, uint32_t px_num);
+#endif
+
 /**********************
  *  STATIC VARIABLES
  **********************/
 
+/* Active window and memory write cursor as last set by a flush, LV_COORD_MIN when unknown */
+static lv_coord_t flush_x1 = LV_COORD_MIN;
+static lv_coord_t flush_x2 = LV_COORD_MIN;
+static lv_coord_t flush_x = LV_COORD_MIN;
+static lv_coord_t flush_y = LV_COORD_MIN;
+
+/* A BTE operation was started and may still be running */
+static bool bte_busy = false;
+
+#if RA8875_DOUBLE_BUFFER
+static uint8_t back_layer = 1;                  // hidden layer, 0 is layer 1
+static lv_area_t dirty[DIRTY_MAX];              // areas drawn into the hidden layer in this frame
+static uint8_t dirty_count = 0;
+static lv_area_t copy_forward[DIRTY_MAX];       // areas of the last frame the hidden layer is missing
+static uint8_t copy_forward_count = 0;
+#endif
+
 /**********************
  *      MACROS
  **********************/
@@ -153,10 +212,7 @@ void ra8875_init(void)
 #endif
     unsigned int i = 0;
 
-    struct {
-        uint8_t cmd;                                   // Register address of command
-        uint8_t data;                                  // Value to write to register
-    } init_cmds[] = {
+    const ra8875_cmd_t init_cmds[] = {
         {RA8875_REG_SYSR,   SYSR_VAL},                 // System Configuration Register (SYSR)
         {RA8875_REG_HDWR,   HDWR_VAL},                 // LCD Horizontal Display Width Register (HDWR)
         {RA8875_REG_HNDFTR, HNDFTR_VAL},               // Horizontal Non-Display Period Fine Tuning Option Register (HNDFTR)
@@ -170,7 +226,7 @@ void ra8875_init(void)
         {RA8875_REG_VSTR0,  VSTR_VAL & 0x0FF},         // VSYNC Start Position Register (VSTR0)
         {RA8875_REG_VSTR1,  VSTR_VAL >> 8},            // VSYNC Start Position Register (VSTR1)
         {RA8875_REG_VPWR,   VPWR_VAL},                 // VSYNC Pulse Width Register (VPWR)
-        {RA8875_REG_DPCR,   DPCR_VAL},                 // Display Configuration Register (DPCR)
+        {RA8875_REG_DPCR,   DPCR_VAL | DPCR_LAYERS},   // Display Configuration Register (DPCR)
         {RA8875_REG_MWCR0,  0x00},                     // Memory Write Control Register 0 (MWCR0)
         {RA8875_REG_MWCR1,  0x00},                     // Memory Write Control Register 1 (MWCR1)
         {RA8875_REG_LTPR0,  0x00},                     // Layer Transparency Register0 (LTPR0)
@@ -188,9 +244,7 @@ void ra8875_init(void)
     disp_spi_change_device_speed(-1);
 
     // Send all the commands
-    for (i = 0; i < INIT_CMDS_SIZE; i++) {
-        ra8875_write_cmd(init_cmds[i].cmd, init_cmds[i].data);
-    }
+    ra8875_write_cmds(init_cmds, INIT_CMDS_SIZE);
 
     // Perform a memory clear (wait maximum of 100 ticks)
     ra8875_write_cmd(RA8875_REG_MCLR, 0x80);
@@ -204,6 +258,13 @@ void ra8875_init(void)
         LV_LOG_WARN("WARNING: Memory clear timed out; RA8875 may be unresponsive.");
     }
 
+#if RA8875_DOUBLE_BUFFER
+    // Layer 1 is shown, flushes draw into layer 2 until the first frame is complete
+    ra8875_write_cmd(RA8875_REG_MWCR1, back_layer);     // Memory Write Control Register 1 (MWCR1)
+#elif defined (CONFIG_LV_DISP_RA8875_DOUBLE_BUFFER)
+    LV_LOG_WARN("Two layers don't fit in the RA8875 display RAM, using one");
+#endif
+
     // Enable the display
     ra8875_enable_display(true);
 }
@@ -218,11 +279,6 @@ void ra8875_enable_display(bool enable)
 
 void ra8875_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-    static lv_coord_t x1 = LV_COORD_MIN;
-    static lv_coord_t x2 = LV_COORD_MIN;
-    static lv_coord_t x = LV_COORD_MIN;
-    static lv_coord_t y = LV_COORD_MIN;
-
     size_t linelen = (area->x2 - area->x1 + 1);
     uint8_t * buffer = (uint8_t*)color_map;
 
@@ -231,9 +287,35 @@ void ra8875_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * colo
     // Get lock
     disp_spi_acquire();
 
+    // The display RAM can't be written while the BTE works on it
+    ra8875_bte_wait();
+
+#if RA8875_DOUBLE_BUFFER
+    ra8875_back_buffer_prepare();
+    ra8875_mark_dirty(area);
+#endif
+
+#if defined (CONFIG_LV_DISP_RA8875_BTE_FILL)
+    // Solid areas are filled by the BTE instead of being sent
+    uint32_t px_num = lv_area_get_size(area);
+    if ((px_num >= BTE_FILL_MIN_PIXELS) && ra8875_area_is_solid(color_map, px_num)) {
+        ra8875_bte_start_fill(area, color_map[0]);
+#if RA8875_DOUBLE_BUFFER
+        if (lv_disp_flush_is_last(drv)) {
+            // The fill belongs to the frame, it has to be complete before the layer is shown
+            ra8875_bte_wait();
+            ra8875_back_buffer_flip();
+        }
+#endif
+        disp_spi_release();
+        lv_disp_flush_ready(drv);
+        return;
+    }
+#endif
+
     // Set window if needed
-    if ((x1 != area->x1) || (x2 != area->x2)) {
-        LV_LOG_INFO("flush: set window (x1,x2): %d,%d -> %d,%d", x1, x2, area->x1, area->x2);
+    if ((flush_x1 != area->x1) || (flush_x2 != area->x2)) {
+        LV_LOG_INFO("flush: set window (x1,x2): %d,%d -> %d,%d", flush_x1, flush_x2, area->x1, area->x2);
         unsigned int ye = 0;
 
 #if LVGL_VERSION_MAJOR < 8
@@ -244,19 +326,19 @@ void ra8875_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * colo
         
         ra8875_set_window(area->x1, area->x2, 0, ye);
         
-        x1 = area->x1;
-        x2 = area->x2;
+        flush_x1 = area->x1;
+        flush_x2 = area->x2;
     }
 
     // Set cursor if needed
-    if ((x != area->x1) || (y != area->y1)) {
-        LV_LOG_INFO("flush: set cursor (x,y): %d,%d -> %d,%d", x, y, area->x1, area->y1);
+    if ((flush_x != area->x1) || (flush_y != area->y1)) {
+        LV_LOG_INFO("flush: set cursor (x,y): %d,%d -> %d,%d", flush_x, flush_y, area->x1, area->y1);
         ra8875_set_memory_write_cursor(area->x1, area->y1);
-        x = area->x1;
+        flush_x = area->x1;
     }
 
     // Update to future cursor location
-    y = area->y2 + 1;
+    flush_y = area->y2 + 1;
     lv_coord_t ver_max = 0;
     
 #if LVGL_VERSION_MAJOR < 8
@@ -266,19 +348,98 @@ void ra8875_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * colo
     ver_max = lv_disp_get_ver_res((lv_disp_t *) drv);
 #endif
     
-    if (y >= ver_max) {
-        y = 0;
+    if (flush_y >= ver_max) {
+        flush_y = 0;
     }
 
     // Write data
     ra8875_send_buffer(buffer, (area->y2 - area->y1 + 1)*BYTES_PER_PIXEL*linelen, true);
 
+#if RA8875_DOUBLE_BUFFER
+    // Show the frame once its last area is in, the flip is queued behind the pixels
+    if (lv_disp_flush_is_last(drv)) {
+        ra8875_back_buffer_flip();
+    }
+#endif
+
     // Release lock
     disp_spi_release();
 }
 
+void ra8875_bte_fill(const lv_area_t * area, lv_color_t color)
+{
+    disp_spi_acquire();
+    ra8875_bte_wait();
+#if RA8875_DOUBLE_BUFFER
+    ra8875_back_buffer_prepare();
+    ra8875_mark_dirty(area);
+#endif
+    ra8875_bte_start_fill(area, color);
+    disp_spi_release();
+}
+
+void ra8875_bte_move(const lv_area_t * src, lv_coord_t x, lv_coord_t y)
+{
+    unsigned int w = lv_area_get_width(src);
+    unsigned int h = lv_area_get_height(src);
+
+    disp_spi_acquire();
+    ra8875_bte_wait();
+
+#if RA8875_DOUBLE_BUFFER
+    lv_area_t dst = {x, y, x + w - 1, y + h - 1};
+    ra8875_back_buffer_prepare();
+    ra8875_mark_dirty(&dst);
+#endif
+
+    // When the destination is below (or right of) an overlapping source, the move has to start at the end so the
+    // source isn't overwritten before it is read; in negative direction the points are the bottom right corners
+    if ((y > src->y1) || ((y == src->y1) && (x > src->x1))) {
+        ra8875_bte_start(BECR1_MOVE_NEG, src->x2, src->y2 | BTE_LAYER(DRAW_LAYER), x + w - 1, (y + h - 1) | BTE_LAYER(DRAW_LAYER), w, h);
+    } else {
+        ra8875_bte_start(BECR1_MOVE_POS, src->x1, src->y1 | BTE_LAYER(DRAW_LAYER), x, y | BTE_LAYER(DRAW_LAYER), w, h);
+    }
+
+    disp_spi_release();
+}
+
+void ra8875_scroll_window(const lv_area_t * area)
+{
+    const ra8875_cmd_t cmds[] = {
+        {RA8875_REG_HSSW0, (uint8_t)(area->x1 & 0x0FF)},   // Horizontal Start Point 0 of Scroll Window (HSSW0)
+        {RA8875_REG_HSSW1, (uint8_t)(area->x1 >> 8)},      // Horizontal Start Point 1 of Scroll Window (HSSW1)
+        {RA8875_REG_VSSW0, (uint8_t)(area->y1 & 0x0FF)},   // Vertical Start Point 0 of Scroll Window (VSSW0)
+        {RA8875_REG_VSSW1, (uint8_t)(area->y1 >> 8)},      // Vertical Start Point 1 of Scroll Window (VSSW1)
+        {RA8875_REG_HESW0, (uint8_t)(area->x2 & 0x0FF)},   // Horizontal End Point 0 of Scroll Window (HESW0)
+        {RA8875_REG_HESW1, (uint8_t)(area->x2 >> 8)},      // Horizontal End Point 1 of Scroll Window (HESW1)
+        {RA8875_REG_VESW0, (uint8_t)(area->y2 & 0x0FF)},   // Vertical End Point 0 of Scroll Window (VESW0)
+        {RA8875_REG_VESW1, (uint8_t)(area->y2 >> 8)},      // Vertical End Point 1 of Scroll Window (VESW1)
+    };
+
+    disp_spi_acquire();
+    ra8875_write_cmds(cmds, sizeof(cmds) / sizeof(cmds[0]));
+    disp_spi_release();
+}
+
+void ra8875_scroll(lv_coord_t x, lv_coord_t y)
+{
+    // Both layers scroll together (LTPR0 scroll mode 0), so a flip doesn't jump
+    const ra8875_cmd_t cmds[] = {
+        {RA8875_REG_HOFS0, (uint8_t)(x & 0x0FF)},          // Horizontal Scroll Offset Register 0 (HOFS0)
+        {RA8875_REG_HOFS1, (uint8_t)((x >> 8) & 0x07)},    // Horizontal Scroll Offset Register 1 (HOFS1)
+        {RA8875_REG_VOFS0, (uint8_t)(y & 0x0FF)},          // Vertical Scroll Offset Register 0 (VOFS0)
+        {RA8875_REG_VOFS1, (uint8_t)((y >> 8) & 0x03)},    // Vertical Scroll Offset Register 1 (VOFS1)
+    };
+
+    disp_spi_acquire();
+    ra8875_write_cmds(cmds, sizeof(cmds) / sizeof(cmds[0]));
+    disp_spi_release();
+}
+
 void ra8875_sleep_in(void)
 {
+    ra8875_bte_wait();
+
     disp_spi_change_device_speed(SPI_CLOCK_SPEED_SLOW_HZ);
 
     ra8875_configure_clocks(false);
@@ -314,6 +475,15 @@ void ra8875_write_cmd(uint8_t cmd, uint8_t data)
     disp_spi_send_data(buf, sizeof(buf));
 }
 
+void ra8875_write_cmds(const ra8875_cmd_t * cmds, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        // 4 bytes are copied into the transaction itself, buf doesn't have to outlive the queued transfer
+        uint8_t buf[4] = {RA8875_MODE_CMD_WRITE, cmds[i].cmd, RA8875_MODE_DATA_WRITE, cmds[i].data};
+        disp_spi_transaction(buf, sizeof(buf), DISP_SPI_SEND_QUEUED, NULL, 0, 0);
+    }
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -336,22 +506,30 @@ void ra8875_configure_clocks(bool high_speed)
 
 static void ra8875_set_window(unsigned int xs, unsigned int xe, unsigned int ys, unsigned int ye)
 {
-    ra8875_write_cmd(RA8875_REG_HSAW0, (uint8_t)(xs & 0x0FF)); // Horizontal Start Point 0 of Active Window (HSAW0)
-    ra8875_write_cmd(RA8875_REG_HSAW1, (uint8_t)(xs >> 8));    // Horizontal Start Point 1 of Active Window (HSAW1)
-    ra8875_write_cmd(RA8875_REG_VSAW0, (uint8_t)(ys & 0x0FF)); // Vertical Start Point 0 of Active Window (VSAW0)
-    ra8875_write_cmd(RA8875_REG_VSAW1, (uint8_t)(ys >> 8));    // Vertical Start Point 1 of Active Window (VSAW1)
-    ra8875_write_cmd(RA8875_REG_HEAW0, (uint8_t)(xe & 0x0FF)); // Horizontal End Point 0 of Active Window (HEAW0)
-    ra8875_write_cmd(RA8875_REG_HEAW1, (uint8_t)(xe >> 8));    // Horizontal End Point 1 of Active Window (HEAW1)
-    ra8875_write_cmd(RA8875_REG_VEAW0, (uint8_t)(ye & 0x0FF)); // Vertical End Point of Active Window 0 (VEAW0)
-    ra8875_write_cmd(RA8875_REG_VEAW1, (uint8_t)(ye >> 8));    // Vertical End Point of Active Window 1 (VEAW1)
+    const ra8875_cmd_t cmds[] = {
+        {RA8875_REG_HSAW0, (uint8_t)(xs & 0x0FF)},     // Horizontal Start Point 0 of Active Window (HSAW0)
+        {RA8875_REG_HSAW1, (uint8_t)(xs >> 8)},        // Horizontal Start Point 1 of Active Window (HSAW1)
+        {RA8875_REG_VSAW0, (uint8_t)(ys & 0x0FF)},     // Vertical Start Point 0 of Active Window (VSAW0)
+        {RA8875_REG_VSAW1, (uint8_t)(ys >> 8)},        // Vertical Start Point 1 of Active Window (VSAW1)
+        {RA8875_REG_HEAW0, (uint8_t)(xe & 0x0FF)},     // Horizontal End Point 0 of Active Window (HEAW0)
+        {RA8875_REG_HEAW1, (uint8_t)(xe >> 8)},        // Horizontal End Point 1 of Active Window (HEAW1)
+        {RA8875_REG_VEAW0, (uint8_t)(ye & 0x0FF)},     // Vertical End Point of Active Window 0 (VEAW0)
+        {RA8875_REG_VEAW1, (uint8_t)(ye >> 8)},        // Vertical End Point of Active Window 1 (VEAW1)
+    };
+
+    ra8875_write_cmds(cmds, sizeof(cmds) / sizeof(cmds[0]));
 }
 
 static void ra8875_set_memory_write_cursor(unsigned int x, unsigned int y)
 {
-    ra8875_write_cmd(RA8875_REG_CURH0, (uint8_t)(x & 0x0FF));  // Memory Write Cursor Horizontal Position Register 0 (CURH0)
-    ra8875_write_cmd(RA8875_REG_CURH1, (uint8_t)(x >> 8));     // Memory Write Cursor Horizontal Position Register 1 (CURH1)
-    ra8875_write_cmd(RA8875_REG_CURV0, (uint8_t)(y & 0x0FF));  // Memory Write Cursor Vertical Position Register 0 (CURV0)
-    ra8875_write_cmd(RA8875_REG_CURV1, (uint8_t)(y >> 8));     // Memory Write Cursor Vertical Position Register 1 (CURV1)
+    const ra8875_cmd_t cmds[] = {
+        {RA8875_REG_CURH0, (uint8_t)(x & 0x0FF)},      // Memory Write Cursor Horizontal Position Register 0 (CURH0)
+        {RA8875_REG_CURH1, (uint8_t)(x >> 8)},         // Memory Write Cursor Horizontal Position Register 1 (CURH1)
+        {RA8875_REG_CURV0, (uint8_t)(y & 0x0FF)},      // Memory Write Cursor Vertical Position Register 0 (CURV0)
+        {RA8875_REG_CURV1, (uint8_t)(y >> 8)},         // Memory Write Cursor Vertical Position Register 1 (CURV1)
+    };
+
+    ra8875_write_cmds(cmds, sizeof(cmds) / sizeof(cmds[0]));
 }
 
 static void ra8875_send_buffer(uint8_t * data, size_t length, bool signal_flush)
@@ -366,6 +544,151 @@ static void ra8875_send_buffer(uint8_t * data, size_t length, bool signal_flush)
     disp_spi_transaction(data, length, flags, NULL, prefix, 0);
 }
 
+static uint8_t ra8875_read_status(void)
+{
+    uint8_t buf[4] = {RA8875_MODE_STATUS_READ, 0x00};
+    disp_spi_transaction(buf, 2, (disp_spi_send_flag_t)(DISP_SPI_RECEIVE | DISP_SPI_SEND_POLLING), buf, 0, 0);
+    return buf[1];
+}
+
+static void ra8875_bte_start(uint8_t becr1, unsigned int sx, unsigned int sy, unsigned int x, unsigned int y, unsigned int w, unsigned int h)
+{
+    // The BTE is clipped to the active window, open it up to the whole screen; the flush sets its own again
+    ra8875_set_window(0, SCREEN_WIDTH - 1, 0, SCREEN_HEIGHT - 1);
+    flush_x1 = LV_COORD_MIN;
+    flush_x2 = LV_COORD_MIN;
+
+    const ra8875_cmd_t cmds[] = {
+        {RA8875_REG_HSBE0, (uint8_t)(sx & 0x0FF)},     // Horizontal Source Point 0 of BTE (HSBE0)
+        {RA8875_REG_HSBE1, (uint8_t)(sx >> 8)},        // Horizontal Source Point 1 of BTE (HSBE1)
+        {RA8875_REG_VSBE0, (uint8_t)(sy & 0x0FF)},     // Vertical Source Point 0 of BTE (VSBE0)
+        {RA8875_REG_VSBE1, (uint8_t)(sy >> 8)},        // Vertical Source Point 1 of BTE (VSBE1)
+        {RA8875_REG_HDBE0, (uint8_t)(x & 0x0FF)},      // Horizontal Destination Point 0 of BTE (HDBE0)
+        {RA8875_REG_HDBE1, (uint8_t)(x >> 8)},         // Horizontal Destination Point 1 of BTE (HDBE1)
+        {RA8875_REG_VDBE0, (uint8_t)(y & 0x0FF)},      // Vertical Destination Point 0 of BTE (VDBE0)
+        {RA8875_REG_VDBE1, (uint8_t)(y >> 8)},         // Vertical Destination Point 1 of BTE (VDBE1)
+        {RA8875_REG_BEWR0, (uint8_t)(w & 0x0FF)},      // BTE Width Register 0 (BEWR0)
+        {RA8875_REG_BEWR1, (uint8_t)(w >> 8)},         // BTE Width Register 1 (BEWR1)
+        {RA8875_REG_BEHR0, (uint8_t)(h & 0x0FF)},      // BTE Height Register 0 (BEHR0)
+        {RA8875_REG_BEHR1, (uint8_t)(h >> 8)},         // BTE Height Register 1 (BEHR1)
+        {RA8875_REG_BECR1, becr1},                     // BTE Function Control Register 1 (BECR1)
+        {RA8875_REG_BECR0, BECR0_BTE_START},           // BTE Function Control Register 0 (BECR0)
+    };
+
+    ra8875_write_cmds(cmds, sizeof(cmds) / sizeof(cmds[0]));
+
+    bte_busy = true;
+}
+
+static void ra8875_bte_wait(void)
+{
+    if (!bte_busy) {
+        return;
+    }
+
+    // A fill of the whole screen takes a few milliseconds, poll a while before sleeping (wait maximum of 100 ticks)
+    unsigned int i;
+    for (i = BTE_WAIT_POLLS + 100; i != 0; i--) {
+        if ((ra8875_read_status() & STSR_BTE_BUSY) == 0x00) {
+            break;
+        }
+        if (i <= 100) {
+            vTaskDelay(1);
+        }
+    }
+    if (i == 0) {
+        LV_LOG_WARN("WARNING: BTE timed out; RA8875 may be unresponsive.");
+    }
+
+    bte_busy = false;
+}
+
+static void ra8875_bte_start_fill(const lv_area_t * area, lv_color_t color)
+{
+    uint32_t c32 = lv_color_to32(color);
+    uint8_t r = (c32 >> 16) & 0xFF;
+    uint8_t g = (c32 >> 8) & 0xFF;
+    uint8_t b = c32 & 0xFF;
+
+    const ra8875_cmd_t cmds[] = {
+#if (LV_COLOR_DEPTH == 16)
+        {RA8875_REG_FGCR0, r >> 3},                    // Foreground Color Register 0, 5 bits of red (FGCR0)
+        {RA8875_REG_FGCR1, g >> 2},                    // Foreground Color Register 1, 6 bits of green (FGCR1)
+        {RA8875_REG_FGCR2, b >> 3},                    // Foreground Color Register 2, 5 bits of blue (FGCR2)
+#else
+        {RA8875_REG_FGCR0, r >> 5},                    // Foreground Color Register 0, 3 bits of red (FGCR0)
+        {RA8875_REG_FGCR1, g >> 5},                    // Foreground Color Register 1, 3 bits of green (FGCR1)
+        {RA8875_REG_FGCR2, b >> 6},                    // Foreground Color Register 2, 2 bits of blue (FGCR2)
+#endif
+    };
+
+    ra8875_write_cmds(cmds, sizeof(cmds) / sizeof(cmds[0]));
+
+    ra8875_bte_start(BECR1_SOLID_FILL, 0, 0, area->x1, area->y1 | BTE_LAYER(DRAW_LAYER), lv_area_get_width(area), lv_area_get_height(area));
+}
+
+#if RA8875_DOUBLE_BUFFER
+static void ra8875_mark_dirty(const lv_area_t * area)
+{
+    if (dirty_count < DIRTY_MAX) {
+        dirty[dirty_count++] = *area;
+        return;
+    }
+
+    // Out of slots, grow the last one to cover the area as well
+    lv_area_t * last = &dirty[DIRTY_MAX - 1];
+    last->x1 = LV_MIN(last->x1, area->x1);
+    last->y1 = LV_MIN(last->y1, area->y1);
+    last->x2 = LV_MAX(last->x2, area->x2);
+    last->y2 = LV_MAX(last->y2, area->y2);
+}
+
+// Before drawing into the hidden layer bring it up to date with the areas of the last frame, the BTE copies them
+// over from the shown layer so only what changed has to be flushed
+static void ra8875_back_buffer_prepare(void)
+{
+    for (uint8_t i = 0; i < copy_forward_count; i++) {
+        const lv_area_t * area = &copy_forward[i];
+
+        ra8875_bte_start(BECR1_MOVE_POS, area->x1, area->y1 | BTE_LAYER(back_layer ^ 1),
+                         area->x1, area->y1 | BTE_LAYER(back_layer),
+                         lv_area_get_width(area), lv_area_get_height(area));
+        ra8875_bte_wait();
+    }
+
+    copy_forward_count = 0;
+}
+
+// Show the hidden layer once the frame is complete and draw the next one into the other
+static void ra8875_back_buffer_flip(void)
+{
+    const ra8875_cmd_t cmds[] = {
+        {RA8875_REG_LTPR0, back_layer},                // Layer Transparency Register0 (LTPR0), only this layer visible
+        {RA8875_REG_MWCR1, back_layer ^ 1},            // Memory Write Control Register 1 (MWCR1), write destination
+    };
+
+    ra8875_write_cmds(cmds, sizeof(cmds) / sizeof(cmds[0]));
+    back_layer ^= 1;
+
+    memcpy(copy_forward, dirty, dirty_count * sizeof(lv_area_t));
+    copy_forward_count = dirty_count;
+    dirty_count = 0;
+}
+#endif
+
+#if defined (CONFIG_LV_DISP_RA8875_BTE_FILL)
+static bool ra8875_area_is_solid(const lv_color_t * color_map, uint32_t px_num)
+{
+    for (uint32_t i = 1; i < px_num; i++) {
+        if (color_map[i].full != color_map[0].full) {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
 static void ra8875_reset(void)
 {
 #if RA8875_USE_RST
@@ -47,6 +47,10 @@ extern "C" {
 
 // LCD Display Control Registers
 #define RA8875_REG_DPCR   (0x20)     // Display Configuration Register (DPCR)
+#define RA8875_REG_HOFS0  (0x24)     // Horizontal Scroll Offset Register 0 (HOFS0)
+#define RA8875_REG_HOFS1  (0x25)     // Horizontal Scroll Offset Register 1 (HOFS1)
+#define RA8875_REG_VOFS0  (0x26)     // Vertical Scroll Offset Register 0 (VOFS0)
+#define RA8875_REG_VOFS1  (0x27)     // Vertical Scroll Offset Register 1 (VOFS1)
 
 // Active Window & Scroll Window Setting Registers
 #define RA8875_REG_HSAW0  (0x30)     // Horizontal Start Point 0 of Active Window (HSAW0)
@@ -57,6 +61,14 @@ extern "C" {
 #define RA8875_REG_HEAW1  (0x35)     // Horizontal End Point 1 of Active Window (HEAW1)
 #define RA8875_REG_VEAW0  (0x36)     // Vertical End Point 0 of Active Window (VEAW0)
 #define RA8875_REG_VEAW1  (0x37)     // Vertical End Point 1 of Active Window (VEAW1)
+#define RA8875_REG_HSSW0  (0x38)     // Horizontal Start Point 0 of Scroll Window (HSSW0)
+#define RA8875_REG_HSSW1  (0x39)     // Horizontal Start Point 1 of Scroll Window (HSSW1)
+#define RA8875_REG_VSSW0  (0x3A)     // Vertical Start Point 0 of Scroll Window (VSSW0)
+#define RA8875_REG_VSSW1  (0x3B)     // Vertical Start Point 1 of Scroll Window (VSSW1)
+#define RA8875_REG_HESW0  (0x3C)     // Horizontal End Point 0 of Scroll Window (HESW0)
+#define RA8875_REG_HESW1  (0x3D)     // Horizontal End Point 1 of Scroll Window (HESW1)
+#define RA8875_REG_VESW0  (0x3E)     // Vertical End Point 0 of Scroll Window (VESW0)
+#define RA8875_REG_VESW1  (0x3F)     // Vertical End Point 1 of Scroll Window (VESW1)
 
 // Cursor Setting Registers
 #define RA8875_REG_MWCR0  (0x40)     // Memory Write Control Register 0 (MWCR0)
@@ -67,8 +79,27 @@ extern "C" {
 #define RA8875_REG_CURV1  (0x49)     // Memory Write Cursor Vertical Position Register 1 (CURV1)
 
 // Block Transfer Engine(BTE) Control Registers
+#define RA8875_REG_BECR0  (0x50)     // BTE Function Control Register 0 (BECR0)
+#define RA8875_REG_BECR1  (0x51)     // BTE Function Control Register 1 (BECR1)
 #define RA8875_REG_LTPR0  (0x52)     // Layer Transparency Register 0 (LTPR0)
 #define RA8875_REG_LTPR1  (0x53)     // Layer Transparency Register 1 (LTPR1)
+#define RA8875_REG_HSBE0  (0x54)     // Horizontal Source Point 0 of BTE (HSBE0)
+#define RA8875_REG_HSBE1  (0x55)     // Horizontal Source Point 1 of BTE (HSBE1)
+#define RA8875_REG_VSBE0  (0x56)     // Vertical Source Point 0 of BTE (VSBE0)
+#define RA8875_REG_VSBE1  (0x57)     // Vertical Source Point 1 of BTE (VSBE1)
+#define RA8875_REG_HDBE0  (0x58)     // Horizontal Destination Point 0 of BTE (HDBE0)
+#define RA8875_REG_HDBE1  (0x59)     // Horizontal Destination Point 1 of BTE (HDBE1)
+#define RA8875_REG_VDBE0  (0x5A)     // Vertical Destination Point 0 of BTE (VDBE0)
+#define RA8875_REG_VDBE1  (0x5B)     // Vertical Destination Point 1 of BTE (VDBE1)
+#define RA8875_REG_BEWR0  (0x5C)     // BTE Width Register 0 (BEWR0)
+#define RA8875_REG_BEWR1  (0x5D)     // BTE Width Register 1 (BEWR1)
+#define RA8875_REG_BEHR0  (0x5E)     // BTE Height Register 0 (BEHR0)
+#define RA8875_REG_BEHR1  (0x5F)     // BTE Height Register 1 (BEHR1)
+
+// Color Registers
+#define RA8875_REG_FGCR0  (0x63)     // Foreground Color Register 0, red (FGCR0)
+#define RA8875_REG_FGCR1  (0x64)     // Foreground Color Register 1, green (FGCR1)
+#define RA8875_REG_FGCR2  (0x65)     // Foreground Color Register 2, blue (FGCR2)
 
 // Touch Panel Control Registers
 #define RA8875_REG_TPCR0  (0x70)     // Touch Panel Control Register 0 (TPCR0)
@@ -91,6 +122,10 @@ extern "C" {
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct {
+    uint8_t cmd;                                   // Register address of command
+    uint8_t data;                                  // Value to write to register
+} ra8875_cmd_t;
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -106,6 +141,56 @@ void ra8875_sleep_out(void);
 uint8_t ra8875_read_cmd(uint8_t cmd);
 void ra8875_write_cmd(uint8_t cmd, uint8_t data);
 
+/**
+ * @brief Write a batch of registers
+ *
+ * The writes are queued back to back instead of waiting for each one, they are sent before any transaction
+ * started after this call.
+ *
+ * @param cmds  Registers and their values, in the order they are written
+ * @param count Number of registers
+ */
+void ra8875_write_cmds(const ra8875_cmd_t * cmds, size_t count);
+
+/* The Block Transfer Engine works on the display RAM without any pixels being sent. Both calls return as soon
+ * as the operation is started, the next flush or BTE operation waits for it to complete. With
+ * LV_DISP_RA8875_DOUBLE_BUFFER they work on the hidden layer, like flushes, and show with the next frame. */
+
+/**
+ * @brief Fill an area of the screen with a color
+ *
+ * @param area  Area to fill
+ * @param color Fill color
+ */
+void ra8875_bte_fill(const lv_area_t * area, lv_color_t color);
+
+/**
+ * @brief Move an area of the screen, e.g. to scroll content that is only partially redrawn
+ *
+ * @param src   Area to move, may overlap its destination
+ * @param x     Left edge of the destination
+ * @param y     Top edge of the destination
+ */
+void ra8875_bte_move(const lv_area_t * src, lv_coord_t x, lv_coord_t y);
+
+/* Hardware scrolling shifts what is shown of the display RAM inside the scroll window, the display RAM itself
+ * (and what LittlevGL knows about it) doesn't change. */
+
+/**
+ * @brief Set the scroll window, the rest of the screen doesn't scroll
+ *
+ * @param area  Scroll window
+ */
+void ra8875_scroll_window(const lv_area_t * area);
+
+/**
+ * @brief Scroll the content of the scroll window
+ *
+ * @param x     Horizontal offset, content wraps around inside the window
+ * @param y     Vertical offset, content wraps around inside the window
+ */
+void ra8875_scroll(lv_coord_t x, lv_coord_t y);
+
 /**********************
  *      MACROS
  **********************/
@@ -29,9 +29,15 @@
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
 #include <driver/gpio.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 
 #include "disp_spi.h"
 #include "disp_driver.h"
+#include "epd_worker.h"
+#include "epd_refresh_policy.h"
+#include "epd_session.h"
+#include "epd_greyscale.h"
 #include "uc8151d.h"
 
 #define PIN_DC              CONFIG_LV_DISP_PIN_DC
@@ -61,6 +67,32 @@
 #endif
 
 #define EPD_ROW_LEN         (EPD_HEIGHT / 8u)
+#define EPD_FB_LEN          ((EPD_HEIGHT * EPD_WIDTH) / 8u)
+// Size of the LVGL framebuffer, two bytes per mono byte in greyscale mode
+#define EPD_LV_FB_LEN       (EPD_FB_LEN * EPD_BITS_PER_PIXEL)
+
+// Most partial refreshes between two full refreshes, 0 always refreshes in full
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+#define EPD_PARTIAL_CNT     0
+#elif defined (CONFIG_LV_EPD_PARTIAL_REFRESH_COUNT)
+#define EPD_PARTIAL_CNT     CONFIG_LV_EPD_PARTIAL_REFRESH_COUNT
+#else
+#define EPD_PARTIAL_CNT     0
+#endif
+
+// Changed pixels a region takes before it gets a clean refresh, percent of its area
+#if defined (CONFIG_LV_EPD_GHOSTING_BUDGET)
+#define EPD_GHOSTING_BUDGET CONFIG_LV_EPD_GHOSTING_BUDGET
+#else
+#define EPD_GHOSTING_BUDGET 150
+#endif
+
+// Idle time before the panel goes to deep sleep, 0 sleeps after every update
+#if defined (CONFIG_LV_EPD_IDLE_POWER_DOWN_MS)
+#define EPD_IDLE_POWER_DOWN_MS  CONFIG_LV_EPD_IDLE_POWER_DOWN_MS
+#else
+#define EPD_IDLE_POWER_DOWN_MS  1000
+#endif
 
 #define BIT_SET(a, b)       ((a) |= (1U << (b)))
 #define BIT_CLEAR(a, b)     ((a) &= ~(1U << (b)))
@@ -74,8 +106,141 @@ typedef struct
 
 #define EPD_SEQ_LEN(x) ((sizeof(x) / sizeof(uc8151d_seq_t)))
 
+// Partial refresh waveform, each group: level select, 4 phase frame counts, repeat count
+static uint8_t lut_vcom1[] = {
+    0x00, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00,
+};
+
+static uint8_t lut_ww1[] = {
+    0x00, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static uint8_t lut_bw1[] = {
+    0x80, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static uint8_t lut_wb1[] = {
+    0x40, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static uint8_t lut_bb1[] = {
+    0x00, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+/*
+ * 4 level greyscale waveform, same group layout as the partial LUTs. The
+ * OLD/NEW data pair selects the LUT, every pixel is shaken black and white
+ * first, then driven towards its grey level.
+ */
+static uint8_t lut_vcom_grey[] = {
+    0x00, 0x0a, 0x00, 0x00, 0x00, 0x01,
+    0x60, 0x14, 0x14, 0x00, 0x00, 0x01,
+    0x00, 0x14, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x13, 0x0a, 0x01, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00,
+};
+
+// OLD 1, NEW 1: white
+static uint8_t lut_ww_grey[] = {
+    0x40, 0x0a, 0x00, 0x00, 0x00, 0x01,
+    0x90, 0x14, 0x14, 0x00, 0x00, 0x01,
+    0x10, 0x14, 0x0a, 0x00, 0x00, 0x01,
+    0xa0, 0x13, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// OLD 0, NEW 1: light grey
+static uint8_t lut_bw_grey[] = {
+    0x40, 0x0a, 0x00, 0x00, 0x00, 0x01,
+    0x90, 0x14, 0x14, 0x00, 0x00, 0x01,
+    0x00, 0x14, 0x0a, 0x00, 0x00, 0x01,
+    0x99, 0x0c, 0x01, 0x03, 0x04, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// OLD 1, NEW 0: dark grey
+static uint8_t lut_wb_grey[] = {
+    0x40, 0x0a, 0x00, 0x00, 0x00, 0x01,
+    0x90, 0x14, 0x14, 0x00, 0x00, 0x01,
+    0x00, 0x14, 0x0a, 0x00, 0x00, 0x01,
+    0x99, 0x0b, 0x04, 0x04, 0x01, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// OLD 0, NEW 0: black
+static uint8_t lut_bb_grey[] = {
+    0x80, 0x0a, 0x00, 0x00, 0x00, 0x01,
+    0x90, 0x14, 0x14, 0x00, 0x00, 0x01,
+    0x20, 0x14, 0x0a, 0x00, 0x00, 0x01,
+    0x50, 0x13, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+#endif
+
 static EventGroupHandle_t uc8151d_evts = NULL;
 
+// Frame currently shown on the panel, diffed against new frames to find the partial window
+static uint8_t *uc8151d_prev_fb = NULL;
+static bool uc8151d_prev_fb_valid = false;
+
+static epd_refresh_policy_t uc8151d_policy;
+
+typedef enum {
+    UC8151D_LUT_NONE,       // Nothing loaded since reset, or lost in deep sleep
+    UC8151D_LUT_PARTIAL,
+    UC8151D_LUT_GREY,
+} uc8151d_lut_t;
+
+// LUT set resident in the LUT registers
+static uc8151d_lut_t uc8151d_resident_lut = UC8151D_LUT_NONE;
+
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+static epd_grey_planes_t uc8151d_grey;
+#endif
+
 static void IRAM_ATTR uc8151d_busy_intr(void *arg)
 {
     BaseType_t xResult;
@@ -107,13 +272,29 @@ static void uc8151d_spi_send_data_byte(uint8_t data)
     disp_spi_send_data(&data, 1);
 }
 
+// Queue data without draining the queue first, the buffer must stay untouched until the next command is sent
+static void uc8151d_spi_queue_data(uint8_t *data, size_t len)
+{
+    gpio_set_level(PIN_DC, 1);  // DC = 1 for data, only data transactions can be in flight here
+    disp_spi_transaction(data, len, DISP_SPI_SEND_QUEUED, NULL, 0, 0);
+}
+
+static void uc8151d_spi_fill_data(uint8_t pattern, size_t len)
+{
+    disp_wait_for_pending_transactions();
+    gpio_set_level(PIN_DC, 1);  // DC = 1 for data
+    disp_spi_send_fill(pattern, len);
+}
+
 static esp_err_t uc8151d_wait_busy(uint32_t timeout_ms)
 {
     uint32_t wait_ticks = (timeout_ms == 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms));
+    int64_t start = esp_timer_get_time();
     EventBits_t bits = xEventGroupWaitBits(uc8151d_evts,
                                            EVT_BUSY, // Wait for busy bit
                                            pdTRUE, pdTRUE,       // Clear on exit, wait for all
                                            wait_ticks);         // Timeout
+    epd_session_add_busy_time(esp_timer_get_time() - start);
 
     return ((bits & EVT_BUSY) != 0) ? ESP_OK : ESP_ERR_TIMEOUT;
 }
@@ -131,10 +312,90 @@ static void uc8151d_sleep(void)
     // Go to sleep
     uc8151d_spi_send_cmd(0x07);
     uc8151d_spi_send_data_byte(0xa5);
+    uc8151d_resident_lut = UC8151D_LUT_NONE;
 }
 
 static void uc8151d_reset(void);
 
+static void uc8151d_panel_use_otp_lut(void)
+{
+    // Panel settings: LUT from OTP
+    uc8151d_spi_send_cmd(0x00);
+#if defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT_INVERTED)
+    uc8151d_spi_send_data_byte(0x13);
+#elif defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT)
+    uc8151d_spi_send_data_byte(0x1f);
+#endif
+
+    // VCOM & Data intervals
+    uc8151d_spi_send_cmd(0x50);
+    uc8151d_spi_send_data_byte(0x97);
+}
+
+// Each LUT goes out as a single queued transaction, the next command waits for it.
+// lut is not copied, so the tables above stay in RAM for the SPI DMA to reach them.
+static void uc8151d_send_lut(uint8_t reg, uint8_t *lut, size_t len)
+{
+    uc8151d_spi_send_cmd(reg);
+    uc8151d_spi_queue_data(lut, len);
+}
+
+static void uc8151d_panel_use_reg_lut(void)
+{
+    // Panel settings: LUT from registers
+    uc8151d_spi_send_cmd(0x00);
+#if defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT_INVERTED)
+    uc8151d_spi_send_data_byte(0x33);
+#elif defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT)
+    uc8151d_spi_send_data_byte(0x3f);
+#endif
+
+    // Same workaround as JD79653A: ignore OLD data or partial refresh won't work
+    uc8151d_spi_send_cmd(0x50);
+    uc8151d_spi_send_data_byte(0xb7);
+
+    if (uc8151d_resident_lut == UC8151D_LUT_PARTIAL) {
+        return;
+    }
+
+    uc8151d_send_lut(0x20, lut_vcom1, sizeof(lut_vcom1));  // LUT VCOM register
+    uc8151d_send_lut(0x21, lut_ww1, sizeof(lut_ww1));      // LUT White-to-White
+    uc8151d_send_lut(0x22, lut_bw1, sizeof(lut_bw1));      // LUT Black-to-White
+    uc8151d_send_lut(0x23, lut_wb1, sizeof(lut_wb1));      // LUT White-to-Black
+    uc8151d_send_lut(0x24, lut_bb1, sizeof(lut_bb1));      // LUT Black-to-Black
+
+    uc8151d_resident_lut = UC8151D_LUT_PARTIAL;
+}
+
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+static void uc8151d_panel_use_grey_lut(void)
+{
+    // Panel settings: LUT from registers
+    uc8151d_spi_send_cmd(0x00);
+#if defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT_INVERTED)
+    uc8151d_spi_send_data_byte(0x33);
+#elif defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT)
+    uc8151d_spi_send_data_byte(0x3f);
+#endif
+
+    // Both OLD and NEW data select the waveform
+    uc8151d_spi_send_cmd(0x50);
+    uc8151d_spi_send_data_byte(0x97);
+
+    if (uc8151d_resident_lut == UC8151D_LUT_GREY) {
+        return;
+    }
+
+    uc8151d_send_lut(0x20, lut_vcom_grey, sizeof(lut_vcom_grey));
+    uc8151d_send_lut(0x21, lut_ww_grey, sizeof(lut_ww_grey));
+    uc8151d_send_lut(0x22, lut_bw_grey, sizeof(lut_bw_grey));
+    uc8151d_send_lut(0x23, lut_wb_grey, sizeof(lut_wb_grey));
+    uc8151d_send_lut(0x24, lut_bb_grey, sizeof(lut_bb_grey));
+
+    uc8151d_resident_lut = UC8151D_LUT_GREY;
+}
+#endif
+
 static void uc8151d_panel_init(void)
 {
     // Hardware reset for 3 times - not sure why but it's from official demo code
@@ -146,45 +407,177 @@ static void uc8151d_panel_init(void)
     uc8151d_spi_send_cmd(0x04);
     uc8151d_wait_busy(0);
 
-    // Panel settings
-    uc8151d_spi_send_cmd(0x00);
-#if defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT_INVERTED)
-    uc8151d_spi_send_data_byte(0x13);
-#elif defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT)
-    uc8151d_spi_send_data_byte(0x1f);
-#endif
+    uc8151d_panel_use_otp_lut();
+}
 
-    // VCOM & Data intervals
-    uc8151d_spi_send_cmd(0x50);
-    uc8151d_spi_send_data_byte(0x97);
+static void uc8151d_remember_frame(const uint8_t *buf)
+{
+    if (uc8151d_prev_fb) {
+        memcpy(uc8151d_prev_fb, buf, EPD_FB_LEN);
+        uc8151d_prev_fb_valid = true;
+    }
 }
 
-static void uc8151d_full_update(uint8_t *buf)
+// Queue the window content row by row, unless the window is as wide as the panel
+static void uc8151d_spi_queue_window(const uint8_t *buf, const lv_area_t *win)
 {
-    uc8151d_panel_init();
+    size_t win_row_len = (win->x2 - win->x1 + 1) / 8;
+    uint8_t *buf_ptr = (uint8_t *) buf + (win->y1 * EPD_ROW_LEN) + (win->x1 / 8);
 
-    uint8_t *buf_ptr = buf;
-    uint8_t old_data[EPD_ROW_LEN] = { 0 };
+    if (win_row_len == EPD_ROW_LEN) {
+        uc8151d_spi_queue_data(buf_ptr, (win->y2 - win->y1 + 1) * EPD_ROW_LEN);
+    } else {
+        for (lv_coord_t row = win->y1; row <= win->y2; row++) {
+            uc8151d_spi_queue_data(buf_ptr, win_row_len);
+            buf_ptr += EPD_ROW_LEN;
+        }
+    }
+}
 
-    // Fill old data
-    uc8151d_spi_send_cmd(0x10);
-    for (size_t h_idx = 0; h_idx < EPD_HEIGHT; h_idx++) {
-        uc8151d_spi_send_data(old_data, EPD_ROW_LEN);
+/**
+ * Refresh a window of the panel. A clean refresh keeps the OTP waveform,
+ * which drives every pixel of the window and removes the ghosting left by
+ * previous partial refreshes, so it needs the OLD frame for the window too.
+ */
+static void uc8151d_partial_update(const lv_area_t *win, uint8_t *buf, bool clean)
+{
+    // The panel stays powered between updates, only the first one of a burst needs the reset sequence
+    epd_session_begin();
+
+    if (clean) {
+        uc8151d_panel_use_otp_lut();
+    } else {
+        uc8151d_panel_use_reg_lut();
+    }
+    LV_LOG_INFO("%s x1: %d, x2: %d, y1: %d, y2: %d", clean ? "Clean" : "Partial",
+                win->x1, win->x2, win->y1, win->y2);
+
+    // Go partial!
+    uc8151d_spi_send_cmd(0x91);
+
+    size_t len = ((win->x2 - win->x1 + 1) * (win->y2 - win->y1 + 1)) / 8;
+    epd_session_add_data_bytes(clean ? (2 * len) : len);
+
+    // Set partial window, x must be byte aligned
+    uint8_t ptl_setting[7] = {
+        win->x1, win->x2,
+        win->y1 >> 8, win->y1 & 0xff,
+        win->y2 >> 8, win->y2 & 0xff,
+        0x01
+    };
+    uc8151d_spi_send_cmd(0x90);
+    uc8151d_spi_send_data(ptl_setting, sizeof(ptl_setting));
+
+    // Only the window content goes in
+    if (clean) {
+        uc8151d_spi_send_cmd(0x10);
+        uc8151d_spi_queue_window(uc8151d_prev_fb, win);
     }
 
-    // Fill new data
     uc8151d_spi_send_cmd(0x13);
-    for (size_t h_idx = 0; h_idx < EPD_HEIGHT; h_idx++) {
-        uc8151d_spi_send_data(buf_ptr, EPD_ROW_LEN);
-        buf_ptr += EPD_ROW_LEN;
+    uc8151d_spi_queue_window(buf, win);
+
+    // Issue refresh
+    uc8151d_spi_send_cmd(0x12);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    uc8151d_wait_busy(0);
+
+    // Out from partial!
+    uc8151d_spi_send_cmd(0x92);
+
+    epd_session_end();
+}
+
+static void uc8151d_full_update(uint8_t *buf)
+{
+    epd_session_begin();
+    uc8151d_panel_use_otp_lut();
+
+    // Old data is the frame on the panel, so the OTP waveform only drives the pixels that change
+    uc8151d_spi_send_cmd(0x10);
+    if (uc8151d_prev_fb_valid) {
+        uc8151d_spi_queue_data(uc8151d_prev_fb, EPD_FB_LEN);
+    } else {
+        uc8151d_spi_fill_data(0x00, EPD_FB_LEN);
     }
 
+    // New data in one go
+    uc8151d_spi_send_cmd(0x13);
+    uc8151d_spi_queue_data(buf, EPD_FB_LEN);
+
+    epd_session_add_data_bytes(2 * EPD_FB_LEN);
+
+    // Issue refresh
+    uc8151d_spi_send_cmd(0x12);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    uc8151d_wait_busy(0);
+
+    uc8151d_remember_frame(buf);
+    epd_refresh_policy_mark_clean(&uc8151d_policy, NULL);
+
+    epd_session_end();
+}
+
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+/**
+ * Draw a 2 bits per pixel frame in a single refresh: the least significant
+ * bit plane goes in as old data, the most significant one as new data, and
+ * the greyscale LUT picks a waveform for each of the four combinations.
+ */
+static void uc8151d_grey_update(const uint8_t *buf)
+{
+    epd_grey_split(&uc8151d_grey, buf);
+
+    epd_session_begin();
+    uc8151d_panel_use_grey_lut();
+
+    uc8151d_spi_send_cmd(0x10);
+    uc8151d_spi_queue_data(uc8151d_grey.lsb, EPD_FB_LEN);
+
+    uc8151d_spi_send_cmd(0x13);
+    uc8151d_spi_queue_data(uc8151d_grey.msb, EPD_FB_LEN);
+
+    epd_session_add_data_bytes(2 * EPD_FB_LEN);
+
     // Issue refresh
     uc8151d_spi_send_cmd(0x12);
     vTaskDelay(pdMS_TO_TICKS(10));
     uc8151d_wait_busy(0);
 
-    uc8151d_sleep();
+    epd_session_end();
+}
+#endif
+
+// Synchronous panel refresh, called from the flush callback or from the background refresh task
+static void uc8151d_refresh(uint8_t *buf, size_t len)
+{
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    // No partial waveform for grey levels, every frame is a full greyscale refresh
+    LV_LOG_INFO("Refreshing greyscale fb with len: %u", len);
+    uc8151d_grey_update(buf);
+#else
+    LV_LOG_INFO("Refreshing fb with len: %u, partials so far: %u", len, uc8151d_policy.partials);
+
+    const uint8_t *prev = uc8151d_prev_fb_valid ? uc8151d_prev_fb : NULL;
+    lv_area_t win;
+
+    switch (epd_refresh_policy_evaluate(&uc8151d_policy, prev, buf, &win)) {
+    case EPD_REFRESH_NONE:
+        LV_LOG_INFO("Frame unchanged, skipping refresh");
+        break;
+    case EPD_REFRESH_FULL:
+        uc8151d_full_update(buf);
+        break;
+    case EPD_REFRESH_CLEAN:
+        uc8151d_partial_update(&win, buf, true);
+        uc8151d_remember_frame(buf);
+        break;
+    default:
+        uc8151d_partial_update(&win, buf, false);
+        uc8151d_remember_frame(buf);
+        break;
+    }
+#endif
 }
 
 void uc8151d_lv_fb_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
@@ -196,7 +589,16 @@ void uc8151d_lv_fb_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *
 #endif
 
     uint8_t *buf = (uint8_t *) color_map;
-    uc8151d_full_update(buf);
+
+#if defined (CONFIG_LV_EPD_BACKGROUND_REFRESH)
+    // The frame is copied, LVGL can render the next one while the panel refreshes,
+    // or drawn here if the refresh task did not start
+    if (!epd_worker_submit(buf)) {
+        uc8151d_refresh(buf, EPD_LV_FB_LEN);
+    }
+#else
+    uc8151d_refresh(buf, EPD_LV_FB_LEN);
+#endif
 
     lv_disp_flush_ready(drv);
     LV_LOG_INFO("Ready");
@@ -208,17 +610,21 @@ void uc8151d_lv_set_fb_cb(lv_disp_drv_t *disp_drv, uint8_t *buf, lv_coord_t buf_
     uint16_t byte_index = (x >> 3u) + (y * EPD_ROW_LEN);
     uint8_t bit_index = x & 0x07u;
 
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    epd_grey_set_px(buf, byte_index, bit_index, epd_grey_level(color));
+#else
     if (color.full) {
         BIT_SET(buf[byte_index], 7 - bit_index);
     } else {
         LV_LOG_INFO("Clear at x: %u, y: %u", x, y);
         BIT_CLEAR(buf[byte_index], 7 - bit_index);
     }
+#endif
 }
 
 void uc8151d_lv_rounder_cb(lv_disp_drv_t *disp_drv, lv_area_t *area)
 {
-    // Always send full framebuffer if it's not in partial mode
+    // Always hand over the full framebuffer, the partial window is found by diffing it against the previous frame
     area->x1 = 0;
     area->y1 = 0;
     area->x2 = EPD_WIDTH - 1;
@@ -247,8 +653,33 @@ void uc8151d_init(void)
     gpio_isr_handler_add(PIN_BUSY, uc8151d_busy_intr, (void *) PIN_BUSY);
 
     LV_LOG_INFO("IO init finished");
-    uc8151d_panel_init();
-    LV_LOG_INFO("Panel initialised");
+
+#if defined (CONFIG_LV_EPD_GREYSCALE)
+    // LVGL renders 2 bpp frames, they cannot be sent without the planes
+    if (!epd_grey_planes_init(&uc8151d_grey, EPD_FB_LEN)) {
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+#endif
+
+    // Keep a copy of the displayed frame, full updates send it as old data and partial updates are diffed against it
+    if (!uc8151d_prev_fb) {
+        uc8151d_prev_fb = heap_caps_malloc(EPD_FB_LEN, MALLOC_CAP_DMA);
+        if (!uc8151d_prev_fb) {
+            LV_LOG_WARN("No memory for the previous frame, partial updates disabled and OLD data left blank");
+        }
+    }
+    uc8151d_prev_fb_valid = false;
+
+    epd_refresh_policy_init(&uc8151d_policy, EPD_WIDTH, EPD_HEIGHT, EPD_GHOSTING_BUDGET, EPD_PARTIAL_CNT);
+
+    // Registers are lost in deep sleep, every session starts with the reset and power up sequence
+    epd_session_init(uc8151d_panel_init, uc8151d_sleep, EPD_IDLE_POWER_DOWN_MS);
+
+#if defined (CONFIG_LV_EPD_BACKGROUND_REFRESH)
+    if (!epd_worker_init(EPD_LV_FB_LEN, uc8151d_refresh)) {
+        LV_LOG_ERROR("Failed when starting the refresh task!");
+    }
+#endif
 }
 
 static void uc8151d_reset(void)
@@ -260,4 +691,5 @@ static void uc8151d_reset(void)
     gpio_set_level(PIN_RST, 1);
     vTaskDelay(pdMS_TO_TICKS(10));
 #endif
+    uc8151d_resident_lut = UC8151D_LUT_NONE;
 }
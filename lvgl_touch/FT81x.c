@@ -22,6 +22,7 @@
 /*********************
  *      DEFINES
  *********************/
+#define FT81X_TOUCH_NONE    0x8000  /* X and Y read when not touched */
 
 /**********************
  *      TYPEDEFS
@@ -30,10 +31,17 @@
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void FT81x_touch_init(void);
+static void FT81x_touch_update(void);
+static void FT81x_touch_add(uint16_t x, uint16_t y);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static bool touch_init_done = false;
+static bool touch_int = false;      /* touches are reported on the INT pin */
+static lv_point_t touch_points[FT81X_TOUCH_POINTS_MAX];
+static uint8_t touch_count = 0;
 
 /**********************
  *      MACROS
@@ -46,6 +54,8 @@
 
 /**
  * Get the current position and state of the touchpad
+ * With the EVE INT pin in use the touch registers are only read once a touch
+ * was reported on it and until it is released, untouched polls cost no SPI traffic.
  * @param data store the read data here
  * @return false: because no more data to be read
  */
@@ -53,33 +63,100 @@ bool FT81x_read(lv_indev_drv_t * drv, lv_indev_data_t * data)
 {
     static int16_t last_x = 0;
     static int16_t last_y = 0;
-   	bool touched = true;
-
-	uint32_t XY = EVE_memRead32(REG_TOUCH_SCREEN_XY);
-	uint16_t Y = XY & 0xffff;
-	uint16_t X = XY >> 16;
-
-	// is it not touched (or invalid because of calibration range)
-	if(X == 0x8000 || Y == 0x8000 || X > LV_HOR_RES_MAX || Y > LV_VER_RES_MAX)
-	{
-		touched = false;
-		X = last_x;
-		Y = last_y;
-	}
-	else
-	{
-		last_x = X;
-		last_y = Y;
-	}
-
-    data->point.x = X;
-    data->point.y = Y;
-    data->state = (touched == false ? LV_INDEV_STATE_REL : LV_INDEV_STATE_PR);
+    bool check = true;
+
+    if (!touch_init_done) {
+        FT81x_touch_init();
+    }
+
+#if EVE_USE_INT
+    if (touch_int) {
+        /* take the flags even while touched, reading them releases the INT line */
+        check = (EVE_int_take_flags(EVE_INT_TOUCH) != 0) || (touch_count > 0);
+    }
+#endif
+
+    if (check) {
+        FT81x_touch_update();
+    }
+
+    if (touch_count > 0) {
+        last_x = touch_points[0].x;
+        last_y = touch_points[0].y;
+    }
+
+    data->point.x = last_x;
+    data->point.y = last_y;
+    data->state = (touch_count == 0 ? LV_INDEV_STATE_REL : LV_INDEV_STATE_PR);
 
     return false;
 }
 
+uint8_t FT81x_touch_get_points(lv_point_t *points, uint8_t max)
+{
+    uint8_t count = (touch_count < max) ? touch_count : max;
+
+    for (uint8_t i = 0; i < count; i++) {
+        points[i] = touch_points[i];
+    }
+
+    return count;
+}
+
 
 /**********************
  *   STATIC FUNCTIONS
  **********************/
+static void FT81x_touch_init(void)
+{
+#if defined (CONFIG_LV_FT81X_TOUCH_MULTI) && defined (REG_CTOUCH_EXTENDED)
+    EVE_memWrite8(REG_CTOUCH_EXTENDED, 0);  /* extended mode, tracks up to 5 touches */
+#endif
+
+#if EVE_USE_INT
+    touch_int = EVE_int_enable(EVE_INT_TOUCH);
+#endif
+
+    touch_init_done = true;
+}
+
+static void FT81x_touch_update(void)
+{
+    touch_count = 0;
+
+#if defined (CONFIG_LV_FT81X_TOUCH_MULTI) && defined (REG_CTOUCH_EXTENDED)
+    /* REG_CTOUCH_TOUCH1_XY, REG_CTOUCH_TOUCH4_Y and REG_CTOUCH_TOUCH0_XY follow each other, as do
+     * REG_CTOUCH_TOUCH2_XY and REG_CTOUCH_TOUCH3_XY, each range is read in one transaction */
+    uint32_t regs[3];
+    EVE_memRead_block(REG_CTOUCH_TOUCH1_XY, (uint8_t *) regs, sizeof(regs));
+
+    FT81x_touch_add(regs[2] >> 16, regs[2] & 0xffff);
+
+    /* further touches are only tracked while the first one is held */
+    if (touch_count > 0) {
+        uint32_t xy[2];
+        EVE_memRead_block(REG_CTOUCH_TOUCH2_XY, (uint8_t *) xy, sizeof(xy));
+
+        FT81x_touch_add(regs[0] >> 16, regs[0] & 0xffff);
+        FT81x_touch_add(xy[0] >> 16, xy[0] & 0xffff);
+        FT81x_touch_add(xy[1] >> 16, xy[1] & 0xffff);
+        FT81x_touch_add(EVE_memRead16(REG_CTOUCH_TOUCH4_X), regs[1] & 0xffff);
+    }
+#else
+    uint32_t xy = EVE_memRead32(REG_TOUCH_SCREEN_XY);
+
+    FT81x_touch_add(xy >> 16, xy & 0xffff);
+#endif
+}
+
+static void FT81x_touch_add(uint16_t x, uint16_t y)
+{
+    /* not touched (or invalid because of calibration range) */
+    if (x == FT81X_TOUCH_NONE || y == FT81X_TOUCH_NONE || x > LV_HOR_RES_MAX || y > LV_VER_RES_MAX) {
+        return;
+    }
+
+    touch_points[touch_count].x = x;
+    touch_points[touch_count].y = y;
+    touch_count++;
+}
@@ -24,6 +24,7 @@ extern "C" {
 /*********************
  *      DEFINES
  *********************/
+#define FT81X_TOUCH_POINTS_MAX  5
 
 /**********************
  *      TYPEDEFS
@@ -35,6 +36,16 @@ extern "C" {
 ;
 bool FT81x_read(lv_indev_drv_t * drv, lv_indev_data_t * data);
 
+/**
+ * Get the touches seen by the last FT81x_read()
+ * Only the first one is reported to LittlevGL, all of them are tracked with
+ * CONFIG_LV_FT81X_TOUCH_MULTI on FT811/FT813/BT815/BT817 capacitive touch.
+ * @param points store the touches here
+ * @param max size of points
+ * @return number of touches stored
+ */
+uint8_t FT81x_touch_get_points(lv_point_t *points, uint8_t max);
+
 /**********************
  *      MACROS
  **********************/
@@ -0,0 +1,1529 @@
+/*
+@file    eve_emu.c
+@brief   host model of an FT81x fed with the SPI traffic of the EVE driver, to test and profile it without a display
+@version 4.1 LvGL edition
+
+The model keeps RAM_G, RAM_DL, the registers and RAM_CMD like the chip does and acts on the writes the driver
+sends: REG_CMD_WRITE runs the co-processor over the FIFO, REG_DLSWAP and CMD_SWAP show the display list built
+in RAM_DL. Writes into RAM_CMD wrap at its end like on the chip, the driver relies on that for bursts crossing it.
+
+The co-processor handles the commands the driver uses to move data and build display lists, the widgets, fonts,
+image decoders, touch and flash commands are reported as unsupported and raise a fault, like an unknown command on
+the chip. The renderer draws bitmaps, points and rectangles with the colour, alpha, scissor and blend state, with
+nearest sampling and without transforms, stencil, tags or anti-aliasing. Good enough to tell a display list is
+right, not a pixel exact copy of the chip.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if EVE_EMU_ZLIB
+#include <zlib.h>
+#endif
+
+#include "eve_emu.h"
+
+/* memory map, registers and commands of the FT81x from the programmers guide, the driver headers are not */
+/* included since they depend on the display configured */
+#define RAM_DL				0x300000UL
+#define RAM_CMD				0x308000UL
+#define IO_BASE				RAM_DL
+#define IO_SIZE				0xA000UL	// RAM_DL, RAM_REG, RAM_CMD and the media FIFO registers
+#define ADDR_MASK			0x3FFFFFUL	// 22 address bits after the two read / write bits
+#define CMD_MASK			(EVE_EMU_RAM_CMD_SIZE - 1)
+
+#define REG_ID				0x302000UL
+#define REG_FRAMES			0x302004UL
+#define REG_CPURESET		0x302020UL
+#define REG_HSIZE			0x302034UL
+#define REG_VSIZE			0x302048UL
+#define REG_DLSWAP			0x302054UL
+#define REG_CMD_READ		0x3020f8UL
+#define REG_CMD_WRITE		0x3020fcUL
+#define REG_CMD_DL			0x302100UL
+#define REG_CMDB_SPACE		0x302574UL
+#define REG_CMDB_WRITE		0x302578UL
+#define REG_MEDIAFIFO_READ	0x309014UL
+#define REG_MEDIAFIFO_WRITE	0x309018UL
+
+#define HOST_CORERST		0x68
+
+#define CMD_DLSTART			0xFFFFFF00UL
+#define CMD_SWAP			0xFFFFFF01UL
+#define CMD_INTERRUPT		0xFFFFFF02UL
+#define CMD_BGCOLOR			0xFFFFFF09UL
+#define CMD_FGCOLOR			0xFFFFFF0AUL
+#define CMD_MEMCRC			0xFFFFFF18UL
+#define CMD_REGREAD			0xFFFFFF19UL
+#define CMD_MEMWRITE		0xFFFFFF1AUL
+#define CMD_MEMSET			0xFFFFFF1BUL
+#define CMD_MEMZERO			0xFFFFFF1CUL
+#define CMD_MEMCPY			0xFFFFFF1DUL
+#define CMD_APPEND			0xFFFFFF1EUL
+#define CMD_INFLATE			0xFFFFFF22UL
+#define CMD_GETPTR			0xFFFFFF23UL
+#define CMD_LOADIDENTITY	0xFFFFFF26UL
+#define CMD_TRANSLATE		0xFFFFFF27UL
+#define CMD_SCALE			0xFFFFFF28UL
+#define CMD_ROTATE			0xFFFFFF29UL
+#define CMD_SETMATRIX		0xFFFFFF2AUL
+#define CMD_SETFONT			0xFFFFFF2BUL
+#define CMD_COLDSTART		0xFFFFFF32UL
+#define CMD_GRADCOLOR		0xFFFFFF34UL
+#define CMD_SETROTATE		0xFFFFFF36UL
+#define CMD_SETBASE			0xFFFFFF38UL
+#define CMD_MEDIAFIFO		0xFFFFFF39UL
+#define CMD_PLAYVIDEO		0xFFFFFF3AUL
+#define CMD_SETFONT2		0xFFFFFF3BUL
+#define CMD_SETSCRATCH		0xFFFFFF3CUL
+#define CMD_ROMFONT			0xFFFFFF3FUL
+#define CMD_SETBITMAP		0xFFFFFF43UL
+#define CMD_INFLATE2		0xFFFFFF50UL
+
+#define OPT_MEDIAFIFO		16UL
+#define OPT_FLASH			64UL
+
+#define PRIM_BITMAPS		1
+#define PRIM_POINTS			2
+#define PRIM_RECTS			9
+
+#define FMT_ARGB1555		0
+#define FMT_L1				1
+#define FMT_L4				2
+#define FMT_L8				3
+#define FMT_RGB332			4
+#define FMT_ARGB2			5
+#define FMT_ARGB4			6
+#define FMT_RGB565			7
+#define FMT_L2				17
+
+#define BLEND_ZERO			0
+#define BLEND_ONE			1
+#define BLEND_SRC_ALPHA		2
+#define BLEND_DST_ALPHA		3
+#define BLEND_ONE_MINUS_SRC_ALPHA	4
+#define BLEND_ONE_MINUS_DST_ALPHA	5
+
+#define CONTEXT_DEPTH		4		// SAVE_CONTEXT levels
+#define CALL_DEPTH			4		// CALL levels
+#define RENDER_STEPS_MAX	(16UL * EVE_EMU_RAM_DL_SIZE / 4)	// a JUMP back would loop forever
+
+typedef enum {
+	STREAM_NONE,
+	STREAM_MEMWRITE,	// CMD_MEMWRITE data
+	STREAM_INFLATE,		// CMD_INFLATE data
+	STREAM_SKIP,		// padding after data, up to the next command
+} stream_kind_t;
+
+typedef struct {
+	uint32_t source;
+	uint8_t format;
+	uint16_t stride;
+	uint16_t layout_height;
+	bool wrapx;			// REPEAT, BORDER otherwise
+	bool wrapy;
+	uint16_t width;
+	uint16_t height;
+} bitmap_handle_t;
+
+typedef struct {
+	uint8_t color[3];
+	uint8_t alpha;
+	uint8_t clear_color[3];
+	uint16_t point_size;	// radius in 1/16 pixel
+	uint8_t handle;
+	uint8_t cell;
+	uint8_t vertex_format;
+	int32_t translate_x;	// 1/16 pixel
+	int32_t translate_y;
+	int32_t scissor_x;
+	int32_t scissor_y;
+	int32_t scissor_w;
+	int32_t scissor_h;
+	uint8_t blend_src;
+	uint8_t blend_dst;
+} gfx_context_t;
+
+struct eve_emu {
+	uint8_t ram_g[EVE_EMU_RAM_G_SIZE];
+	uint8_t io[IO_SIZE];
+	uint8_t dl_shown[EVE_EMU_RAM_DL_SIZE];	// the list swapped in, RAM_DL is where the next one is built
+
+	uint32_t rd;		// co-processor read offset in RAM_CMD
+	bool reset;			// held in reset by REG_CPURESET
+	bool fault;
+	bool running;		// a MEMWRITE to REG_CMD_WRITE must not start it again from within
+
+	struct {
+		stream_kind_t kind;
+		uint32_t dest;
+		uint32_t left;		// data bytes still to come, STREAM_MEMWRITE and STREAM_SKIP
+		uint32_t total;		// data bytes taken so far, to pad to the next command
+	} stream;
+#if EVE_EMU_ZLIB
+	z_stream zs;
+#endif
+	uint32_t last_ptr;	// end of the last inflated data, for CMD_GETPTR
+
+	bitmap_handle_t handles[32];
+
+	uint8_t *fb;
+	uint32_t fb_width;
+	uint32_t fb_height;
+
+	eve_emu_stats_t stats;
+	uint64_t frame_start;	// spi_bytes at the last swap
+};
+
+typedef struct {
+	uint32_t cmd;
+	uint8_t params;		// bytes following the command
+} copro_cmd_t;
+
+static const copro_cmd_t copro_cmds[] = {
+	{CMD_DLSTART, 0}, {CMD_SWAP, 0}, {CMD_INTERRUPT, 4}, {CMD_COLDSTART, 0},
+	{CMD_BGCOLOR, 4}, {CMD_FGCOLOR, 4}, {CMD_GRADCOLOR, 4},
+	{CMD_LOADIDENTITY, 0}, {CMD_TRANSLATE, 8}, {CMD_SCALE, 8}, {CMD_ROTATE, 4}, {CMD_SETMATRIX, 0},
+	{CMD_SETFONT, 8}, {CMD_SETFONT2, 12}, {CMD_ROMFONT, 8}, {CMD_SETSCRATCH, 4},
+	{CMD_SETROTATE, 4}, {CMD_SETBASE, 4},
+	{CMD_MEMWRITE, 8}, {CMD_MEMSET, 12}, {CMD_MEMZERO, 8}, {CMD_MEMCPY, 12}, {CMD_MEMCRC, 12},
+	{CMD_REGREAD, 8}, {CMD_APPEND, 8}, {CMD_INFLATE, 4}, {CMD_INFLATE2, 8}, {CMD_GETPTR, 4},
+	{CMD_MEDIAFIFO, 8}, {CMD_PLAYVIDEO, 4}, {CMD_SETBITMAP, 12},
+};
+
+static eve_emu_t *attached = NULL;
+
+static void copro_run(eve_emu_t *emu);
+
+
+static uint32_t get32(const uint8_t *p)
+{
+	return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+static void put32(uint8_t *p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+}
+
+
+static uint32_t reg_get(eve_emu_t *emu, uint32_t reg)
+{
+	return get32(&emu->io[reg - IO_BASE]);
+}
+
+
+static void reg_set(eve_emu_t *emu, uint32_t reg, uint32_t value)
+{
+	put32(&emu->io[reg - IO_BASE], value);
+}
+
+
+static uint8_t *fifo(eve_emu_t *emu)
+{
+	return &emu->io[RAM_CMD - IO_BASE];
+}
+
+
+static uint32_t fifo_get32(eve_emu_t *emu, uint32_t offset)
+{
+	uint32_t value = 0;
+
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		value |= (uint32_t)fifo(emu)[(offset + i) & CMD_MASK] << (8 * i);
+	}
+
+	return value;
+}
+
+
+static void fifo_put32(eve_emu_t *emu, uint32_t offset, uint32_t value)
+{
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		fifo(emu)[(offset + i) & CMD_MASK] = (uint8_t)(value >> (8 * i));
+	}
+}
+
+
+static void fifo_copy(eve_emu_t *emu, uint32_t offset, uint8_t *data, uint32_t length)
+{
+	for(uint32_t i = 0; i < length; i++)
+	{
+		data[i] = fifo(emu)[(offset + i) & CMD_MASK];
+	}
+}
+
+
+static void note_unsupported(eve_emu_t *emu, uint32_t what)
+{
+	emu->stats.unsupported++;
+	emu->stats.last_unsupported = what;
+}
+
+
+/* memory map */
+
+static void mem_read(eve_emu_t *emu, uint32_t addr, uint8_t *data, size_t length)
+{
+	for(size_t i = 0; i < length; i++)
+	{
+		uint32_t a = addr + i;
+
+		if(addr >= RAM_CMD && addr < RAM_CMD + EVE_EMU_RAM_CMD_SIZE)
+		{
+			data[i] = fifo(emu)[(addr - RAM_CMD + i) & CMD_MASK];
+		}
+		else if(a < EVE_EMU_RAM_G_SIZE)
+		{
+			data[i] = emu->ram_g[a];
+		}
+		else if(a >= IO_BASE && a < IO_BASE + IO_SIZE)
+		{
+			data[i] = emu->io[a - IO_BASE];
+		}
+		else
+		{
+			data[i] = 0;	// ROM and unmapped
+		}
+	}
+}
+
+
+static uint32_t mem_read32(eve_emu_t *emu, uint32_t addr)
+{
+	uint8_t data[4];
+
+	mem_read(emu, addr, data, sizeof(data));
+	return get32(data);
+}
+
+
+static void dl_swap(eve_emu_t *emu)
+{
+	memcpy(emu->dl_shown, emu->io, EVE_EMU_RAM_DL_SIZE);
+
+	emu->stats.frames++;
+	emu->stats.frame_bytes = emu->stats.spi_bytes - emu->frame_start;
+	emu->frame_start = emu->stats.spi_bytes;
+
+	reg_set(emu, REG_FRAMES, reg_get(emu, REG_FRAMES) + 1);
+}
+
+
+static void stream_cancel(eve_emu_t *emu)
+{
+#if EVE_EMU_ZLIB
+	if(emu->stream.kind == STREAM_INFLATE)
+	{
+		inflateEnd(&emu->zs);
+	}
+#endif
+	emu->stream.kind = STREAM_NONE;
+}
+
+
+/* the co-processor stops at a fault until it is reset */
+static void copro_fault(eve_emu_t *emu)
+{
+	stream_cancel(emu);
+	emu->fault = true;
+	emu->stats.faults++;
+	reg_set(emu, REG_CMD_READ, 0xFFF);
+}
+
+
+/* REG_CMDB_WRITE appends what is written to it to the FIFO */
+static void cmdb_write(eve_emu_t *emu, const uint8_t *data, size_t length)
+{
+	uint32_t wr = reg_get(emu, REG_CMD_WRITE) & CMD_MASK;
+
+	for(size_t i = 0; i < length; i++)
+	{
+		fifo(emu)[(wr + i) & CMD_MASK] = data[i];
+	}
+
+	reg_set(emu, REG_CMD_WRITE, (wr + length) & CMD_MASK);
+	copro_run(emu);
+}
+
+
+/* act on registers the write covered */
+static void reg_written(eve_emu_t *emu, uint32_t addr, size_t length)
+{
+#define WRITTEN(reg)	(addr < (reg) + 4 && addr + length > (reg))
+
+	if(WRITTEN(REG_CMD_READ) && emu->reset)
+	{
+		emu->rd = reg_get(emu, REG_CMD_READ) & CMD_MASK;
+	}
+
+	if(WRITTEN(REG_CPURESET))
+	{
+		if(reg_get(emu, REG_CPURESET) & 1)
+		{
+			stream_cancel(emu);
+			emu->reset = true;
+		}
+		else if(emu->reset)
+		{
+			emu->reset = false;
+			emu->fault = false;
+			emu->rd = reg_get(emu, REG_CMD_READ) & CMD_MASK;
+			reg_set(emu, REG_CMD_READ, emu->rd);
+			copro_run(emu);
+		}
+	}
+
+	if(WRITTEN(REG_DLSWAP) && reg_get(emu, REG_DLSWAP) != 0)
+	{
+		dl_swap(emu);	// right away, the model has no scan out to wait for
+		reg_set(emu, REG_DLSWAP, 0);
+	}
+
+	if(WRITTEN(REG_MEDIAFIFO_WRITE))
+	{
+		reg_set(emu, REG_MEDIAFIFO_READ, reg_get(emu, REG_MEDIAFIFO_WRITE));	// taken right away
+	}
+
+	if(WRITTEN(REG_CMD_WRITE))
+	{
+		copro_run(emu);
+	}
+
+#undef WRITTEN
+}
+
+
+static void mem_write(eve_emu_t *emu, uint32_t addr, const uint8_t *data, size_t length)
+{
+	if(addr >= RAM_CMD && addr < RAM_CMD + EVE_EMU_RAM_CMD_SIZE)
+	{
+		// wraps to the start of RAM_CMD instead of going on into the registers behind it
+		for(size_t i = 0; i < length; i++)
+		{
+			fifo(emu)[(addr - RAM_CMD + i) & CMD_MASK] = data[i];
+		}
+	}
+	else if(addr == REG_CMDB_WRITE)
+	{
+		cmdb_write(emu, data, length);
+	}
+	else if(addr < EVE_EMU_RAM_G_SIZE)
+	{
+		size_t n = (length > EVE_EMU_RAM_G_SIZE - addr) ? EVE_EMU_RAM_G_SIZE - addr : length;
+		memcpy(&emu->ram_g[addr], data, n);
+	}
+	else if(addr >= IO_BASE && addr < IO_BASE + IO_SIZE)
+	{
+		size_t n = (length > IO_BASE + IO_SIZE - addr) ? IO_BASE + IO_SIZE - addr : length;
+		memcpy(&emu->io[addr - IO_BASE], data, n);
+		reg_written(emu, addr, n);
+	}
+}
+
+
+static void host_command(eve_emu_t *emu, uint8_t command)
+{
+	if(command == HOST_CORERST)
+	{
+		stream_cancel(emu);
+		emu->fault = false;
+		emu->rd = 0;
+		reg_set(emu, REG_CMD_READ, 0);
+		reg_set(emu, REG_CMD_WRITE, 0);
+		reg_set(emu, REG_CMD_DL, 0);
+	}
+
+	// ACTIVE, the clock and power commands don't change anything the model keeps
+}
+
+
+/* co-processor */
+
+static void dl_append(eve_emu_t *emu, uint32_t word)
+{
+	uint32_t offset = reg_get(emu, REG_CMD_DL);
+
+	if(offset + 4 > EVE_EMU_RAM_DL_SIZE)
+	{
+		emu->stats.dl_overflows++;
+		return;
+	}
+
+	put32(&emu->io[offset], word);
+	reg_set(emu, REG_CMD_DL, offset + 4);
+	emu->stats.dl_words++;
+}
+
+
+static uint8_t format_bits(uint8_t format)
+{
+	switch(format)
+	{
+		case FMT_L1:
+			return 1;
+		case FMT_L2:
+			return 2;
+		case FMT_L4:
+			return 4;
+		case FMT_L8:
+		case FMT_RGB332:
+		case FMT_ARGB2:
+			return 8;
+		case FMT_ARGB1555:
+		case FMT_ARGB4:
+		case FMT_RGB565:
+			return 16;
+		default:
+			return 0;	// paletted and the text formats are not modelled
+	}
+}
+
+
+static void copro_setbitmap(eve_emu_t *emu, uint32_t addr, uint32_t format, uint32_t width, uint32_t height)
+{
+	uint32_t stride = (width * format_bits(format) + 7) / 8;
+
+	dl_append(emu, (1UL << 24) | (addr & ADDR_MASK));
+	dl_append(emu, (7UL << 24) | ((format & 31) << 19) | ((stride & 1023) << 9) | (height & 511));
+	dl_append(emu, (40UL << 24) | (((stride >> 10) & 3) << 2) | ((height >> 9) & 3));
+	dl_append(emu, (8UL << 24) | ((width & 511) << 9) | (height & 511));	// NEAREST, BORDER, BORDER
+	dl_append(emu, (41UL << 24) | (((width >> 9) & 3) << 2) | ((height >> 9) & 3));
+}
+
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+	for(uint32_t i = 0; i < length; i++)
+	{
+		crc ^= data[i];
+		for(uint8_t bit = 0; bit < 8; bit++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+		}
+	}
+
+	return crc;
+}
+
+
+static void stream_start(eve_emu_t *emu, stream_kind_t kind, uint32_t dest, uint32_t length)
+{
+	emu->stream.kind = kind;
+	emu->stream.dest = dest;
+	emu->stream.left = length;
+	emu->stream.total = 0;
+}
+
+
+/* the data is padded to the next DWORD in the FIFO */
+static void stream_end(eve_emu_t *emu)
+{
+	uint32_t padding = (4 - (emu->stream.total & 3)) & 3;
+
+	emu->stream.kind = (padding > 0) ? STREAM_SKIP : STREAM_NONE;
+	emu->stream.left = padding;
+}
+
+
+/* take up to available bytes of the data following the command, returns how many were taken */
+static uint32_t stream_feed(eve_emu_t *emu, uint32_t available)
+{
+	uint8_t data[EVE_EMU_RAM_CMD_SIZE];
+	uint32_t length = available;
+
+	if(emu->stream.kind != STREAM_INFLATE && length > emu->stream.left)
+	{
+		length = emu->stream.left;
+	}
+
+	switch(emu->stream.kind)
+	{
+		case STREAM_SKIP:
+			emu->stream.left -= length;
+			if(emu->stream.left == 0)
+			{
+				emu->stream.kind = STREAM_NONE;
+			}
+			return length;
+
+		case STREAM_MEMWRITE:
+			fifo_copy(emu, emu->rd, data, length);
+			mem_write(emu, emu->stream.dest, data, length);
+			emu->stream.dest += length;
+			emu->stream.left -= length;
+			emu->stream.total += length;
+			if(emu->stream.left == 0)
+			{
+				stream_end(emu);
+			}
+			return length;
+
+#if EVE_EMU_ZLIB
+		case STREAM_INFLATE:
+		{
+			fifo_copy(emu, emu->rd, data, length);
+
+			emu->zs.next_in = data;
+			emu->zs.avail_in = length;
+			emu->zs.next_out = &emu->ram_g[emu->stream.dest + emu->zs.total_out];
+			emu->zs.avail_out = EVE_EMU_RAM_G_SIZE - (emu->stream.dest + emu->zs.total_out);
+
+			int ret = inflate(&emu->zs, Z_NO_FLUSH);
+			uint32_t used = length - emu->zs.avail_in;
+			emu->stream.total += used;
+
+			if(ret == Z_STREAM_END)
+			{
+				emu->last_ptr = emu->stream.dest + emu->zs.total_out;
+				inflateEnd(&emu->zs);
+				stream_end(emu);
+			}
+			else if((ret != Z_OK && ret != Z_BUF_ERROR) || emu->zs.avail_out == 0)
+			{
+				copro_fault(emu);	// corrupt data or out of RAM_G
+			}
+			return used;
+		}
+#endif
+
+		default:
+			return 0;
+	}
+}
+
+
+static bool copro_inflate(eve_emu_t *emu, uint32_t dest)
+{
+#if EVE_EMU_ZLIB
+	if(dest >= EVE_EMU_RAM_G_SIZE)
+	{
+		return false;
+	}
+
+	memset(&emu->zs, 0, sizeof(emu->zs));
+	if(inflateInit(&emu->zs) != Z_OK)
+	{
+		return false;
+	}
+
+	stream_start(emu, STREAM_INFLATE, dest, 0);
+	return true;
+#else
+	(void)dest;
+	note_unsupported(emu, CMD_INFLATE);	// built without zlib
+	return false;
+#endif
+}
+
+
+/* execute a command with its parameters p, at is its offset in the FIFO for the results, false on a fault */
+static bool copro_execute(eve_emu_t *emu, uint32_t cmd, const uint32_t *p, uint32_t at)
+{
+	uint8_t data[256];
+
+	switch(cmd)
+	{
+		case CMD_DLSTART:
+			reg_set(emu, REG_CMD_DL, 0);
+			break;
+
+		case CMD_SWAP:
+			dl_swap(emu);
+			break;
+
+		case CMD_MEMWRITE:
+			stream_start(emu, STREAM_MEMWRITE, p[0] & ADDR_MASK, p[1]);
+			if(p[1] == 0)
+			{
+				stream_end(emu);
+			}
+			break;
+
+		case CMD_MEMSET:
+		case CMD_MEMZERO:
+		{
+			uint32_t length = (cmd == CMD_MEMSET) ? p[2] : p[1];
+
+			memset(data, (cmd == CMD_MEMSET) ? (uint8_t)p[1] : 0, sizeof(data));
+			for(uint32_t done = 0; done < length; done += sizeof(data))
+			{
+				uint32_t n = (length - done > sizeof(data)) ? sizeof(data) : length - done;
+				mem_write(emu, (p[0] + done) & ADDR_MASK, data, n);
+			}
+			break;
+		}
+
+		case CMD_MEMCPY:
+			for(uint32_t done = 0; done < p[2]; done += sizeof(data))
+			{
+				uint32_t n = (p[2] - done > sizeof(data)) ? sizeof(data) : p[2] - done;
+				mem_read(emu, (p[1] + done) & ADDR_MASK, data, n);
+				mem_write(emu, (p[0] + done) & ADDR_MASK, data, n);
+			}
+			break;
+
+		case CMD_MEMCRC:
+		{
+			uint32_t crc = 0xFFFFFFFFUL;
+
+			for(uint32_t done = 0; done < p[1]; done += sizeof(data))
+			{
+				uint32_t n = (p[1] - done > sizeof(data)) ? sizeof(data) : p[1] - done;
+				mem_read(emu, (p[0] + done) & ADDR_MASK, data, n);
+				crc = crc32_update(crc, data, n);
+			}
+			fifo_put32(emu, at + 12, ~crc);
+			break;
+		}
+
+		case CMD_REGREAD:
+			fifo_put32(emu, at + 8, mem_read32(emu, p[0] & ADDR_MASK));
+			break;
+
+		case CMD_APPEND:
+			for(uint32_t done = 0; done + 4 <= p[1]; done += 4)
+			{
+				dl_append(emu, mem_read32(emu, (p[0] + done) & ADDR_MASK));
+			}
+			break;
+
+		case CMD_INFLATE:
+			return copro_inflate(emu, p[0] & ADDR_MASK);
+
+		case CMD_INFLATE2:
+			if(p[1] & (OPT_MEDIAFIFO | OPT_FLASH))
+			{
+				note_unsupported(emu, cmd);
+				return false;
+			}
+			return copro_inflate(emu, p[0] & ADDR_MASK);
+
+		case CMD_GETPTR:
+			fifo_put32(emu, at + 4, emu->last_ptr);
+			break;
+
+		case CMD_MEDIAFIFO:
+			reg_set(emu, REG_MEDIAFIFO_READ, 0);
+			reg_set(emu, REG_MEDIAFIFO_WRITE, 0);
+			break;
+
+		case CMD_PLAYVIDEO:
+			// the video is not decoded, from the media FIFO it is taken as a whole, in the FIFO its end is unknown
+			note_unsupported(emu, cmd);
+			if(!(p[0] & OPT_MEDIAFIFO))
+			{
+				return false;
+			}
+			reg_set(emu, REG_MEDIAFIFO_READ, reg_get(emu, REG_MEDIAFIFO_WRITE));
+			break;
+
+		case CMD_SETBITMAP:
+			copro_setbitmap(emu, p[0], p[1] & 0xFFFF, p[1] >> 16, p[2] & 0xFFFF);
+			break;
+
+		default:
+			break;	// state the renderer has no use for
+	}
+
+	return true;
+}
+
+
+static const copro_cmd_t *copro_find(uint32_t cmd)
+{
+	for(size_t i = 0; i < sizeof(copro_cmds) / sizeof(copro_cmds[0]); i++)
+	{
+		if(copro_cmds[i].cmd == cmd)
+		{
+			return &copro_cmds[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+/* work through the FIFO up to REG_CMD_WRITE, or up to a command that is not complete yet */
+static void copro_run(eve_emu_t *emu)
+{
+	if(emu->reset || emu->fault || emu->running)
+	{
+		return;
+	}
+
+	emu->running = true;
+
+	uint32_t wr = reg_get(emu, REG_CMD_WRITE) & CMD_MASK;
+
+	while(!emu->fault)
+	{
+		uint32_t available = (wr - emu->rd) & CMD_MASK;
+		if(available == 0)
+		{
+			break;
+		}
+
+		if(emu->stream.kind != STREAM_NONE)
+		{
+			stream_kind_t kind = emu->stream.kind;
+			uint32_t used = stream_feed(emu, available);
+
+			emu->rd = (emu->rd + used) & CMD_MASK;
+			if(used == 0 && emu->stream.kind == kind)
+			{
+				break;	// waiting for more data
+			}
+			continue;
+		}
+
+		if(available < 4)
+		{
+			break;
+		}
+
+		uint32_t cmd = fifo_get32(emu, emu->rd);
+
+		if((cmd & 0xFFFFFF00UL) != 0xFFFFFF00UL)
+		{
+			dl_append(emu, cmd);	// display list words go straight to RAM_DL
+			emu->rd = (emu->rd + 4) & CMD_MASK;
+			continue;
+		}
+
+		const copro_cmd_t *info = copro_find(cmd);
+		if(info == NULL)
+		{
+			note_unsupported(emu, cmd);
+			copro_fault(emu);
+			break;
+		}
+
+		if(available < 4UL + info->params)
+		{
+			break;
+		}
+
+		uint32_t p[3] = {0};
+		for(uint8_t i = 0; i < info->params / 4; i++)
+		{
+			p[i] = fifo_get32(emu, emu->rd + 4 + 4 * i);
+		}
+
+		uint32_t at = emu->rd;
+		emu->rd = (emu->rd + 4 + info->params) & CMD_MASK;
+		emu->stats.commands++;
+
+		if(!copro_execute(emu, cmd, p, at))
+		{
+			copro_fault(emu);
+		}
+	}
+
+	if(!emu->fault)
+	{
+		reg_set(emu, REG_CMD_READ, emu->rd);
+		reg_set(emu, REG_CMDB_SPACE, (EVE_EMU_RAM_CMD_SIZE - 4) - ((wr - emu->rd) & CMD_MASK));
+	}
+	else
+	{
+		reg_set(emu, REG_CMDB_SPACE, 0);
+	}
+
+	emu->running = false;
+}
+
+
+/* renderer */
+
+typedef struct {
+	eve_emu_t *emu;
+	gfx_context_t ctx;
+	gfx_context_t saved[CONTEXT_DEPTH];
+	uint8_t saved_count;
+	uint8_t primitive;
+	bool have_corner;	// first vertex of a rectangle seen
+	int32_t corner_x;
+	int32_t corner_y;
+} render_t;
+
+
+static const gfx_context_t context_default = {
+	.color = {255, 255, 255},
+	.alpha = 255,
+	.point_size = 16,
+	.vertex_format = 4,
+	.scissor_w = 2048,
+	.scissor_h = 2048,
+	.blend_src = BLEND_SRC_ALPHA,
+	.blend_dst = BLEND_ONE_MINUS_SRC_ALPHA,
+};
+
+
+/* limit x0..x1, y0..y1 (exclusive) to the scissor and the screen, false if nothing is left */
+static bool render_clip(render_t *r, int32_t *x0, int32_t *y0, int32_t *x1, int32_t *y1)
+{
+	const gfx_context_t *ctx = &r->ctx;
+
+	if(*x0 < ctx->scissor_x) *x0 = ctx->scissor_x;
+	if(*y0 < ctx->scissor_y) *y0 = ctx->scissor_y;
+	if(*x1 > ctx->scissor_x + ctx->scissor_w) *x1 = ctx->scissor_x + ctx->scissor_w;
+	if(*y1 > ctx->scissor_y + ctx->scissor_h) *y1 = ctx->scissor_y + ctx->scissor_h;
+	if(*x0 < 0) *x0 = 0;
+	if(*y0 < 0) *y0 = 0;
+	if(*x1 > (int32_t)r->emu->fb_width) *x1 = r->emu->fb_width;
+	if(*y1 > (int32_t)r->emu->fb_height) *y1 = r->emu->fb_height;
+
+	return (*x0 < *x1) && (*y0 < *y1);
+}
+
+
+static uint32_t blend_factor(uint8_t func, uint8_t alpha)
+{
+	switch(func)
+	{
+		case BLEND_ZERO:
+		case BLEND_ONE_MINUS_DST_ALPHA:		// the frame buffer is opaque
+			return 0;
+		case BLEND_SRC_ALPHA:
+			return alpha;
+		case BLEND_ONE_MINUS_SRC_ALPHA:
+			return 255 - alpha;
+		default:	// ONE, DST_ALPHA
+			return 255;
+	}
+}
+
+
+static void render_pixel(render_t *r, int32_t x, int32_t y, const uint8_t *rgb, uint8_t alpha)
+{
+	uint8_t *pixel = &r->emu->fb[(y * r->emu->fb_width + x) * 3];
+	uint32_t src = blend_factor(r->ctx.blend_src, alpha);
+	uint32_t dst = blend_factor(r->ctx.blend_dst, alpha);
+
+	for(uint8_t i = 0; i < 3; i++)
+	{
+		uint32_t value = (rgb[i] * src + pixel[i] * dst + 127) / 255;
+		pixel[i] = (value > 255) ? 255 : value;
+	}
+}
+
+
+static void render_clear(render_t *r)
+{
+	int32_t x0 = 0, y0 = 0, x1 = r->emu->fb_width, y1 = r->emu->fb_height;
+
+	if(!render_clip(r, &x0, &y0, &x1, &y1))
+	{
+		return;
+	}
+
+	for(int32_t y = y0; y < y1; y++)
+	{
+		for(int32_t x = x0; x < x1; x++)
+		{
+			memcpy(&r->emu->fb[(y * r->emu->fb_width + x) * 3], r->ctx.clear_color, 3);
+		}
+	}
+}
+
+
+static uint8_t expand(uint32_t value, uint8_t bits)
+{
+	return (uint8_t)((value * 255) / ((1U << bits) - 1));
+}
+
+
+/* texel x of the row at addr as r, g, b, a */
+static void texel_fetch(eve_emu_t *emu, uint8_t format, uint32_t addr, uint32_t x, uint8_t *rgba)
+{
+	uint8_t bits = format_bits(format);
+	uint32_t bit = x * bits;
+	uint8_t data[2] = {0};
+
+	mem_read(emu, (addr + bit / 8) & ADDR_MASK, data, (bits == 16) ? 2 : 1);
+
+	uint32_t v16 = data[0] | ((uint32_t)data[1] << 8);
+	uint32_t v = (bits < 8) ? (data[0] >> (8 - bits - (bit & 7))) & ((1U << bits) - 1) : data[0];
+
+	switch(format)
+	{
+		case FMT_L1:
+		case FMT_L2:
+		case FMT_L4:
+		case FMT_L8:
+			rgba[0] = rgba[1] = rgba[2] = 255;	// luminance is coverage, drawn in the current colour
+			rgba[3] = expand(v, bits);
+			break;
+		case FMT_RGB332:
+			rgba[0] = expand(v >> 5, 3);
+			rgba[1] = expand((v >> 2) & 7, 3);
+			rgba[2] = expand(v & 3, 2);
+			rgba[3] = 255;
+			break;
+		case FMT_ARGB2:
+			rgba[0] = expand((v >> 4) & 3, 2);
+			rgba[1] = expand((v >> 2) & 3, 2);
+			rgba[2] = expand(v & 3, 2);
+			rgba[3] = expand(v >> 6, 2);
+			break;
+		case FMT_ARGB1555:
+			rgba[0] = expand((v16 >> 10) & 31, 5);
+			rgba[1] = expand((v16 >> 5) & 31, 5);
+			rgba[2] = expand(v16 & 31, 5);
+			rgba[3] = (v16 & 0x8000) ? 255 : 0;
+			break;
+		case FMT_ARGB4:
+			rgba[0] = expand((v16 >> 8) & 15, 4);
+			rgba[1] = expand((v16 >> 4) & 15, 4);
+			rgba[2] = expand(v16 & 15, 4);
+			rgba[3] = expand(v16 >> 12, 4);
+			break;
+		default:	// FMT_RGB565
+			rgba[0] = expand(v16 >> 11, 5);
+			rgba[1] = expand((v16 >> 5) & 63, 6);
+			rgba[2] = expand(v16 & 31, 5);
+			rgba[3] = 255;
+			break;
+	}
+}
+
+
+static void render_bitmap(render_t *r, int32_t left, int32_t top, uint8_t handle, uint8_t cell)
+{
+	const bitmap_handle_t *bitmap = &r->emu->handles[handle];
+	uint8_t bits = format_bits(bitmap->format);
+
+	if(bits == 0)
+	{
+		note_unsupported(r->emu, (7UL << 24) | ((uint32_t)bitmap->format << 19));
+		return;
+	}
+
+	uint32_t width = bitmap->width ? bitmap->width : 2048;
+	uint32_t height = bitmap->height ? bitmap->height : 2048;
+	uint32_t layout_width = bitmap->stride * 8 / bits;
+	uint32_t layout_height = bitmap->layout_height ? bitmap->layout_height : 2048;
+	uint32_t base = bitmap->source + (uint32_t)cell * bitmap->stride * layout_height;
+
+	int32_t x0 = left, y0 = top, x1 = left + width, y1 = top + height;
+
+	if(layout_width == 0 || !render_clip(r, &x0, &y0, &x1, &y1))
+	{
+		return;
+	}
+
+	for(int32_t y = y0; y < y1; y++)
+	{
+		uint32_t ty = y - top;
+
+		if(ty >= layout_height)
+		{
+			if(!bitmap->wrapy)
+			{
+				continue;	// BORDER is transparent
+			}
+			ty %= layout_height;
+		}
+
+		for(int32_t x = x0; x < x1; x++)
+		{
+			uint32_t tx = x - left;
+			uint8_t texel[4];
+			uint8_t rgb[3];
+
+			if(tx >= layout_width)
+			{
+				if(!bitmap->wrapx)
+				{
+					continue;
+				}
+				tx %= layout_width;
+			}
+
+			texel_fetch(r->emu, bitmap->format, base + ty * bitmap->stride, tx, texel);
+			for(uint8_t i = 0; i < 3; i++)
+			{
+				rgb[i] = (texel[i] * r->ctx.color[i] + 127) / 255;
+			}
+			render_pixel(r, x, y, rgb, (texel[3] * r->ctx.alpha + 127) / 255);
+		}
+	}
+}
+
+
+static void render_point(render_t *r, int32_t cx, int32_t cy)
+{
+	int32_t radius = r->ctx.point_size;
+	int32_t x0 = (cx - radius) >> 4, y0 = (cy - radius) >> 4;
+	int32_t x1 = ((cx + radius) >> 4) + 1, y1 = ((cy + radius) >> 4) + 1;
+
+	if(!render_clip(r, &x0, &y0, &x1, &y1))
+	{
+		return;
+	}
+
+	for(int32_t y = y0; y < y1; y++)
+	{
+		for(int32_t x = x0; x < x1; x++)
+		{
+			int32_t dx = x * 16 + 8 - cx, dy = y * 16 + 8 - cy;
+
+			if(dx * dx + dy * dy <= radius * radius)
+			{
+				render_pixel(r, x, y, r->ctx.color, r->ctx.alpha);
+			}
+		}
+	}
+}
+
+
+/* square corners, the pixels of both corners included */
+static void render_rect(render_t *r, int32_t ax, int32_t ay, int32_t bx, int32_t by)
+{
+	int32_t x0 = ((ax < bx) ? ax : bx) >> 4, y0 = ((ay < by) ? ay : by) >> 4;
+	int32_t x1 = (((ax > bx) ? ax : bx) >> 4) + 1, y1 = (((ay > by) ? ay : by) >> 4) + 1;
+
+	if(!render_clip(r, &x0, &y0, &x1, &y1))
+	{
+		return;
+	}
+
+	for(int32_t y = y0; y < y1; y++)
+	{
+		for(int32_t x = x0; x < x1; x++)
+		{
+			render_pixel(r, x, y, r->ctx.color, r->ctx.alpha);
+		}
+	}
+}
+
+
+/* a vertex at x, y in 1/16 pixel, translated already */
+static void render_vertex(render_t *r, int32_t x, int32_t y, uint8_t handle, uint8_t cell)
+{
+	switch(r->primitive)
+	{
+		case 0:
+			break;	// outside BEGIN / END
+		case PRIM_BITMAPS:
+			render_bitmap(r, x >> 4, y >> 4, handle, cell);
+			break;
+		case PRIM_POINTS:
+			render_point(r, x, y);
+			break;
+		case PRIM_RECTS:
+			if(r->have_corner)
+			{
+				render_rect(r, r->corner_x, r->corner_y, x, y);
+			}
+			else
+			{
+				r->corner_x = x;
+				r->corner_y = y;
+			}
+			r->have_corner = !r->have_corner;
+			break;
+		default:	// lines and edge strips
+			note_unsupported(r->emu, (0x1FUL << 24) | r->primitive);
+			break;
+	}
+}
+
+
+static int32_t sign_extend(uint32_t value, uint8_t bits)
+{
+	uint32_t sign = 1UL << (bits - 1);
+
+	value &= (1UL << bits) - 1;
+	return (int32_t)(value ^ sign) - (int32_t)sign;
+}
+
+
+/* state a plain colour render has to leave at its default, true if the word sets it to that */
+static bool render_default(uint32_t word)
+{
+	switch(word >> 24)
+	{
+		case 0x09:	// ALPHA_FUNC(ALWAYS, 0)
+			return (word & 0x7FF) == 0x700;
+		case 0x0A:	// STENCIL_FUNC(ALWAYS, 0, 255)
+			return (word & 0xFFFFF) == 0x700FF;
+		case 0x0C:	// STENCIL_OP(KEEP, KEEP)
+			return (word & 0x3F) == 0x09;
+		case 0x15:	// BITMAP_TRANSFORM_A .. F, identity
+		case 0x19:
+			return (word & 0x1FFFF) == 256;
+		case 0x16:
+		case 0x17:
+		case 0x18:
+		case 0x1A:
+			return (word & 0xFFFFFF) == 0;
+		case 0x20:	// COLOR_MASK(1, 1, 1, 1)
+			return (word & 0xF) == 0xF;
+		default:
+			return false;
+	}
+}
+
+
+static void render_list(eve_emu_t *emu)
+{
+	render_t r = {.emu = emu, .ctx = context_default};
+	uint32_t calls[CALL_DEPTH];
+	uint8_t call_count = 0;
+	uint32_t pc = 0;
+
+	memset(emu->fb, 0, emu->fb_width * emu->fb_height * 3);
+
+	for(uint32_t steps = 0; steps < RENDER_STEPS_MAX && pc < EVE_EMU_RAM_DL_SIZE / 4; steps++)
+	{
+		uint32_t word = get32(&emu->dl_shown[pc * 4]);
+		gfx_context_t *ctx = &r.ctx;
+		bitmap_handle_t *bitmap = &emu->handles[ctx->handle];
+
+		pc++;
+
+		if((word >> 30) == 1)	// VERTEX2F
+		{
+			int32_t x = sign_extend(word >> 15, 15), y = sign_extend(word, 15);
+
+			x = x * 16 / (1 << ctx->vertex_format);
+			y = y * 16 / (1 << ctx->vertex_format);
+			render_vertex(&r, x + ctx->translate_x, y + ctx->translate_y, ctx->handle, ctx->cell);
+			continue;
+		}
+
+		if((word >> 30) == 2)	// VERTEX2II
+		{
+			int32_t x = (word >> 21) & 511, y = (word >> 12) & 511;
+
+			render_vertex(&r, x * 16 + ctx->translate_x, y * 16 + ctx->translate_y, (word >> 7) & 31, word & 127);
+			continue;
+		}
+
+		switch(word >> 24)
+		{
+			case 0x00:	// DISPLAY
+				return;
+			case 0x01:	// BITMAP_SOURCE
+				bitmap->source = word & ADDR_MASK;
+				break;
+			case 0x02:	// CLEAR_COLOR_RGB
+				ctx->clear_color[0] = word >> 16;
+				ctx->clear_color[1] = word >> 8;
+				ctx->clear_color[2] = word;
+				break;
+			case 0x03:	// TAG
+			case 0x0E:	// LINE_WIDTH
+			case 0x0F:	// CLEAR_COLOR_A
+			case 0x11:	// CLEAR_STENCIL
+			case 0x12:	// CLEAR_TAG
+			case 0x13:	// STENCIL_MASK
+			case 0x14:	// TAG_MASK
+			case 0x2D:	// NOP
+				break;
+			case 0x04:	// COLOR_RGB
+				ctx->color[0] = word >> 16;
+				ctx->color[1] = word >> 8;
+				ctx->color[2] = word;
+				break;
+			case 0x05:	// BITMAP_HANDLE
+				ctx->handle = word & 31;
+				break;
+			case 0x06:	// CELL
+				ctx->cell = word & 127;
+				break;
+			case 0x07:	// BITMAP_LAYOUT, clears what BITMAP_LAYOUT_H sets
+				bitmap->format = (word >> 19) & 31;
+				bitmap->stride = (word >> 9) & 1023;
+				bitmap->layout_height = word & 511;
+				break;
+			case 0x28:	// BITMAP_LAYOUT_H
+				bitmap->stride = (bitmap->stride & 1023) | (((word >> 2) & 3) << 10);
+				bitmap->layout_height = (bitmap->layout_height & 511) | ((word & 3) << 9);
+				break;
+			case 0x08:	// BITMAP_SIZE, clears what BITMAP_SIZE_H sets
+				bitmap->wrapx = (word >> 19) & 1;
+				bitmap->wrapy = (word >> 18) & 1;
+				bitmap->width = (word >> 9) & 511;
+				bitmap->height = word & 511;
+				break;
+			case 0x29:	// BITMAP_SIZE_H
+				bitmap->width = (bitmap->width & 511) | (((word >> 2) & 3) << 9);
+				bitmap->height = (bitmap->height & 511) | ((word & 3) << 9);
+				break;
+			case 0x0B:	// BLEND_FUNC
+				ctx->blend_src = (word >> 3) & 7;
+				ctx->blend_dst = word & 7;
+				break;
+			case 0x0D:	// POINT_SIZE
+				ctx->point_size = word & 8191;
+				break;
+			case 0x10:	// COLOR_A
+				ctx->alpha = word;
+				break;
+			case 0x1B:	// SCISSOR_XY
+				ctx->scissor_x = (word >> 11) & 2047;
+				ctx->scissor_y = word & 2047;
+				break;
+			case 0x1C:	// SCISSOR_SIZE
+				ctx->scissor_w = (word >> 12) & 4095;
+				ctx->scissor_h = word & 4095;
+				break;
+			case 0x1D:	// CALL
+				if(call_count == CALL_DEPTH)
+				{
+					note_unsupported(emu, word);
+					return;
+				}
+				calls[call_count++] = pc;
+				pc = word & 0xFFFF;
+				break;
+			case 0x1E:	// JUMP
+				pc = word & 0xFFFF;
+				break;
+			case 0x24:	// RETURN
+				if(call_count == 0)
+				{
+					return;
+				}
+				pc = calls[--call_count];
+				break;
+			case 0x1F:	// BEGIN
+				r.primitive = word & 15;
+				r.have_corner = false;
+				break;
+			case 0x21:	// END
+				r.primitive = 0;
+				break;
+			case 0x22:	// SAVE_CONTEXT
+				if(r.saved_count < CONTEXT_DEPTH)
+				{
+					r.saved[r.saved_count++] = r.ctx;
+				}
+				break;
+			case 0x23:	// RESTORE_CONTEXT
+				if(r.saved_count > 0)
+				{
+					r.ctx = r.saved[--r.saved_count];
+				}
+				break;
+			case 0x26:	// CLEAR, only the colour buffer is kept
+				if(word & 4)
+				{
+					render_clear(&r);
+				}
+				break;
+			case 0x27:	// VERTEX_FORMAT
+				ctx->vertex_format = ((word & 7) > 4) ? 4 : (word & 7);
+				break;
+			case 0x2B:	// VERTEX_TRANSLATE_X
+				ctx->translate_x = sign_extend(word, 17);
+				break;
+			case 0x2C:	// VERTEX_TRANSLATE_Y
+				ctx->translate_y = sign_extend(word, 17);
+				break;
+			default:
+				if(!render_default(word))
+				{
+					note_unsupported(emu, word);
+				}
+				break;
+		}
+	}
+}
+
+
+/* public interface */
+
+eve_emu_t *eve_emu_create(void)
+{
+	eve_emu_t *emu = calloc(1, sizeof(eve_emu_t));
+	if(emu == NULL)
+	{
+		return NULL;
+	}
+
+	reg_set(emu, REG_ID, 0x7C);
+	reg_set(emu, REG_CMDB_SPACE, EVE_EMU_RAM_CMD_SIZE - 4);
+
+	return emu;
+}
+
+
+void eve_emu_destroy(eve_emu_t *emu)
+{
+	if(emu == NULL)
+	{
+		return;
+	}
+
+	if(attached == emu)
+	{
+		attached = NULL;
+	}
+
+	stream_cancel(emu);
+	free(emu->fb);
+	free(emu);
+}
+
+
+void eve_emu_attach(eve_emu_t *emu)
+{
+	attached = emu;
+}
+
+
+void eve_emu_trace_cb(const uint8_t *data, size_t length, disp_spi_send_flag_t flags, uint64_t addr)
+{
+	eve_emu_t *emu = attached;
+
+	if(emu == NULL)
+	{
+		return;
+	}
+
+	emu->stats.transactions++;
+
+	if(flags & DISP_SPI_ADDRESS_24)
+	{
+		emu->stats.spi_bytes += 3 + length;
+
+		// reads are answered by eve_emu_read_cb()
+		if(!(flags & DISP_SPI_RECEIVE) && data != NULL)
+		{
+			mem_write(emu, (uint32_t)addr & ADDR_MASK, data, length);
+		}
+		return;
+	}
+
+	emu->stats.spi_bytes += length;
+
+	if(data == NULL || length < 3)
+	{
+		return;
+	}
+
+	if((data[0] & 0xC0) == 0x80)	// memory write with the address in front of the data
+	{
+		uint32_t write_addr = ((uint32_t)(data[0] & 0x3F) << 16) | ((uint32_t)data[1] << 8) | data[2];
+		mem_write(emu, write_addr, data + 3, length - 3);
+	}
+	else
+	{
+		host_command(emu, data[0]);
+	}
+}
+
+
+void eve_emu_read_cb(uint64_t addr, uint8_t *data, size_t length)
+{
+	if(attached == NULL)
+	{
+		memset(data, 0, length);
+		return;
+	}
+
+	mem_read(attached, (uint32_t)addr & ADDR_MASK, data, length);
+}
+
+
+void eve_emu_read(eve_emu_t *emu, uint32_t addr, uint8_t *data, size_t length)
+{
+	mem_read(emu, addr & ADDR_MASK, data, length);
+}
+
+
+void eve_emu_write(eve_emu_t *emu, uint32_t addr, const uint8_t *data, size_t length)
+{
+	mem_write(emu, addr & ADDR_MASK, data, length);
+}
+
+
+uint32_t eve_emu_reg(eve_emu_t *emu, uint32_t addr)
+{
+	return mem_read32(emu, addr & ADDR_MASK);
+}
+
+
+const uint8_t *eve_emu_render(eve_emu_t *emu, uint32_t *width, uint32_t *height)
+{
+	uint32_t w = reg_get(emu, REG_HSIZE) & 4095;
+	uint32_t h = reg_get(emu, REG_VSIZE) & 4095;
+
+	if(w == 0 || h == 0)
+	{
+		return NULL;
+	}
+
+	if(w != emu->fb_width || h != emu->fb_height)
+	{
+		uint8_t *fb = realloc(emu->fb, w * h * 3);
+		if(fb == NULL)
+		{
+			return NULL;
+		}
+
+		emu->fb = fb;
+		emu->fb_width = w;
+		emu->fb_height = h;
+	}
+
+	render_list(emu);
+
+	if(width != NULL)
+	{
+		*width = w;
+	}
+	if(height != NULL)
+	{
+		*height = h;
+	}
+
+	return emu->fb;
+}
+
+
+bool eve_emu_write_ppm(eve_emu_t *emu, const char *path)
+{
+	uint32_t width, height;
+	const uint8_t *rgb = eve_emu_render(emu, &width, &height);
+
+	if(rgb == NULL)
+	{
+		return false;
+	}
+
+	FILE *file = fopen(path, "wb");
+	if(file == NULL)
+	{
+		return false;
+	}
+
+	fprintf(file, "P6\n%u %u\n255\n", (unsigned)width, (unsigned)height);
+	bool ok = fwrite(rgb, 3, width * height, file) == width * height;
+
+	return (fclose(file) == 0) && ok;
+}
+
+
+void eve_emu_get_stats(eve_emu_t *emu, eve_emu_stats_t *stats)
+{
+	*stats = emu->stats;
+}
+
+
+void eve_emu_reset_stats(eve_emu_t *emu)
+{
+	memset(&emu->stats, 0, sizeof(emu->stats));
+	emu->frame_start = 0;
+}
@@ -0,0 +1,63 @@
+/*
+@file    eve_emu.h
+@brief   host model of an FT81x fed with the SPI traffic of the EVE driver, to test and profile it without a display
+@version 4.1 LvGL edition
+*/
+
+#ifndef EVE_EMU_H_
+#define EVE_EMU_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "disp_spi.h"
+
+#define EVE_EMU_RAM_G_SIZE		(1024UL * 1024UL)
+#define EVE_EMU_RAM_DL_SIZE		8192UL
+#define EVE_EMU_RAM_CMD_SIZE	4096UL
+
+typedef struct eve_emu eve_emu_t;
+
+typedef struct {
+	uint32_t transactions;		// SPI transactions seen, reads included
+	uint64_t spi_bytes;			// bytes on the wire, with the 3 address bytes of memory reads and writes
+	uint32_t frames;			// display lists swapped in, by REG_DLSWAP or CMD_SWAP
+	uint64_t frame_bytes;		// spi_bytes from the swap before the last one up to the last one
+	uint32_t commands;			// co-processor commands executed, display list words not counted
+	uint32_t dl_words;			// display list words written to RAM_DL by the co-processor
+	uint32_t dl_overflows;		// display list words dropped past the end of RAM_DL
+	uint32_t faults;			// co-processor faults, REG_CMD_READ reads 0xFFF until the driver recovers
+	uint32_t unsupported;		// commands, display list words and bitmap formats the model does not handle
+	uint32_t last_unsupported;	// the last of them
+} eve_emu_stats_t;
+
+/* Create a model in the state EVE_init() expects after power up, NULL if out of memory. */
+eve_emu_t *eve_emu_create(void);
+void eve_emu_destroy(eve_emu_t *emu);
+
+/* The model eve_emu_trace_cb() and eve_emu_read_cb() work on, the trace callback has no context pointer. */
+void eve_emu_attach(eve_emu_t *emu);
+
+/* Pass to disp_spi_set_trace_cb(), every write is applied to the attached model as the chip would. */
+void eve_emu_trace_cb(const uint8_t *data, size_t length, disp_spi_send_flag_t flags, uint64_t addr);
+
+/* Read length bytes at addr of the attached model, for the host disp_spi to answer read transactions. */
+void eve_emu_read_cb(uint64_t addr, uint8_t *data, size_t length);
+
+/* Read and write the memory map directly, without going through SPI or counting traffic. */
+void eve_emu_read(eve_emu_t *emu, uint32_t addr, uint8_t *data, size_t length);
+void eve_emu_write(eve_emu_t *emu, uint32_t addr, const uint8_t *data, size_t length);
+uint32_t eve_emu_reg(eve_emu_t *emu, uint32_t addr);
+
+/* Draw the display list shown, as RGB888 rows of REG_HSIZE x REG_VSIZE pixels. The buffer belongs to the model */
+/* and stays valid until the next call. Returns NULL if the size registers are not set yet. */
+const uint8_t *eve_emu_render(eve_emu_t *emu, uint32_t *width, uint32_t *height);
+
+/* Render and write the frame as a binary PPM, returns false if there is no frame or the file could not be written. */
+bool eve_emu_write_ppm(eve_emu_t *emu, const char *path);
+
+void eve_emu_get_stats(eve_emu_t *emu, eve_emu_stats_t *stats);
+void eve_emu_reset_stats(eve_emu_t *emu);
+
+#endif /* EVE_EMU_H_ */
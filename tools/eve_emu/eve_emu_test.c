@@ -0,0 +1,658 @@
+/*
+@file    eve_emu_test.c
+@brief   runs the EVE driver against the host model of the FT81x and checks what the chip would hold and show
+@version 4.1 LvGL edition
+
+Usage: eve_emu_test [frame.ppm], the frame drawn last is written to the file if one is given.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if EVE_EMU_ZLIB
+#include <zlib.h>
+#endif
+
+#include "EVE.h"
+#include "EVE_commands.h"
+#include "EVE_assets.h"
+#include "EVE_deflate.h"
+#include "FT81x.h"
+#include "disp_spi.h"
+#include "disp_spi_host.h"
+#include "eve_emu.h"
+
+#define SCRATCH_ADDR	0x0E0000UL	// memory commands, in the part of RAM_G FT81x.c only uses during flushes
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+extern volatile uint16_t cmdOffset;	// EVE_commands.c
+extern uint8_t tft_active;			// FT81x.c
+
+static eve_emu_t *emu;
+static int failures = 0;
+
+
+static void check(bool ok, const char *what, int line)
+{
+	if(!ok)
+	{
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, line, what);
+		failures++;
+	}
+}
+
+
+static uint32_t reg(uint32_t addr)
+{
+	return eve_emu_reg(emu, addr);
+}
+
+
+static void test_init(void)
+{
+	FT81x_init();
+	CHECK(tft_active == 1);
+	CHECK(reg(REG_HSIZE) == EVE_HSIZE);
+	CHECK(reg(REG_VSIZE) == EVE_VSIZE);
+	CHECK(reg(REG_CMD_READ) == cmdOffset);
+}
+
+
+static void test_memory(void)
+{
+	uint8_t data[300];
+	uint8_t back[sizeof(data)];
+
+	for(uint32_t i = 0; i < sizeof(data); i++)
+	{
+		data[i] = (uint8_t)(i * 13 + 5);
+	}
+
+	EVE_memWrite_buffer(SCRATCH_ADDR, data, sizeof(data), false);
+	EVE_memRead_block(SCRATCH_ADDR, back, sizeof(back));
+	CHECK(memcmp(data, back, sizeof(data)) == 0);
+
+	EVE_memWrite32(SCRATCH_ADDR, 0x12345678UL);
+	CHECK(EVE_memRead32(SCRATCH_ADDR) == 0x12345678UL);
+	CHECK(EVE_memRead16(SCRATCH_ADDR + 2) == 0x1234);
+	CHECK(EVE_memRead8(SCRATCH_ADDR + 1) == 0x56);
+}
+
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+
+/* EVE_memWrite_buffer() splits writes into DWORD multiples of the largest transaction the bus takes */
+static void test_memwrite_chunks(void)
+{
+	static uint8_t data[800 * 480 * 2];	// an 800x480 RGB565 screen, it fits in RAM_G at its start
+	static uint8_t back[sizeof(data)];
+	static const uint32_t lengths[] = {1, 3, 999, 1000, 1001, 2001};
+	lv_disp_drv_t *drv = &_lv_refr_get_disp_refreshing()->driver;
+	disp_spi_stats_t before, after;
+	uint32_t ready;
+
+	for(uint32_t i = 0; i < sizeof(data); i++)
+	{
+		data[i] = (uint8_t)((i * 7) ^ (i >> 11));
+	}
+
+	disp_spi_set_max_transfer_size(1003);	// 1000 byte chunks
+
+	disp_spi_get_stats(&before);
+	ready = drv->flush_ready;
+	EVE_memWrite_buffer(0, data, sizeof(data), true);
+	disp_spi_get_stats(&after);
+
+	eve_emu_read(emu, 0, back, sizeof(data));
+	CHECK(memcmp(data, back, sizeof(data)) == 0);
+	CHECK(after.transactions - before.transactions == sizeof(data) / 1000);
+	CHECK(after.tx_bytes - before.tx_bytes == sizeof(data));
+	CHECK(drv->flush_ready == ready + 1);	// signalled by the last chunk only
+
+	for(uint32_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+	{
+		uint32_t addr = SCRATCH_ADDR + 1 + (i * 0x1000);	// odd, with the bytes around it cleared
+		uint8_t guard[2];
+
+		EVE_cmd_memzero(addr - 1, lengths[i] + 2);
+		EVE_cmd_execute();
+
+		disp_spi_get_stats(&before);
+		EVE_memWrite_buffer(addr, data + i, lengths[i], false);
+		disp_spi_get_stats(&after);
+
+		eve_emu_read(emu, addr, back, lengths[i]);
+		CHECK(memcmp(data + i, back, lengths[i]) == 0);
+		CHECK(after.transactions - before.transactions == (lengths[i] + 999) / 1000);
+
+		eve_emu_read(emu, addr - 1, &guard[0], 1);
+		eve_emu_read(emu, addr + lengths[i], &guard[1], 1);
+		CHECK(guard[0] == 0 && guard[1] == 0);
+	}
+
+	disp_spi_set_max_transfer_size(0);
+}
+
+
+/* a display list of CMD_DLSTART and 199 display list commands */
+static void dl_build(bool burst)
+{
+	for(uint32_t i = 0; i < 200; i++)
+	{
+		uint32_t command = (i == 0) ? CMD_DLSTART : VERTEX2F(i * 16, i * 8);
+
+		if(burst && (i % 50) == 0)
+		{
+			EVE_start_cmd_burst();	// as many commands as TFT_bitmap_display() sends in one
+		}
+
+		EVE_cmd_dl(command);
+
+		if(burst && (i % 50) == 49)
+		{
+			EVE_end_cmd_burst();
+		}
+	}
+}
+
+
+/* building a display list queues its transactions and never waits for the ones before, prints how long it takes */
+static void test_dl_build(void)
+{
+	const uint32_t rounds = 100;
+
+	for(int burst = 0; burst <= 1; burst++)
+	{
+		uint32_t transactions = 0;
+		uint32_t blocking = 0;
+		uint32_t drains = 0;
+		double us = 0;
+
+		for(uint32_t i = 0; i < rounds; i++)
+		{
+			disp_spi_stats_t before, after;
+
+			EVE_cmd_execute();	// not timed, the FIFO holds only a few lists
+
+			disp_spi_get_stats(&before);
+			uint32_t drained = disp_spi_host_get_drain_count();
+			double start = now_us();
+			dl_build(burst);
+			us += now_us() - start;
+			disp_spi_get_stats(&after);
+
+			transactions += after.transactions - before.transactions;
+			blocking += after.blocking - before.blocking;
+			drains += disp_spi_host_get_drain_count() - drained;
+		}
+
+		EVE_cmd_execute();
+		CHECK(reg(REG_CMD_DL) == 199 * 4);
+		CHECK(reg(EVE_RAM_DL + 198 * 4) == VERTEX2F(199 * 16, 199 * 8));
+		CHECK(transactions == rounds * (burst ? 4 : 200));
+		CHECK(blocking == 0 && drains == 0);
+
+		printf("200 command display list %-12s %6.2f us in %3u transactions\n",
+			burst ? "in bursts:" : "one by one:", us / rounds, (unsigned)(transactions / rounds));
+	}
+}
+
+
+static void test_copro_memory(void)
+{
+	static uint8_t data[6000];
+	static uint8_t back[sizeof(data)];
+
+	EVE_cmd_memset(SCRATCH_ADDR, 0xA5, 100);
+	EVE_cmd_memcpy(SCRATCH_ADDR + 0x100, SCRATCH_ADDR, 100);
+	EVE_cmd_memzero(SCRATCH_ADDR + 0x100, 10);
+	EVE_cmd_execute();
+
+	EVE_memRead_block(SCRATCH_ADDR + 0x100, back, 100);
+	CHECK(back[9] == 0 && back[10] == 0xA5 && back[99] == 0xA5);
+
+	// more than the FIFO holds, streamed through it while the co-processor takes it
+	for(uint32_t i = 0; i < sizeof(data); i++)
+	{
+		data[i] = (uint8_t)(i ^ (i >> 8));
+	}
+
+	EVE_cmd_memwrite(SCRATCH_ADDR + 0x1000, sizeof(data) - 1, data);	// odd length, padded in the FIFO
+	EVE_cmd_execute();
+
+	eve_emu_read(emu, SCRATCH_ADDR + 0x1000, back, sizeof(data) - 1);
+	CHECK(memcmp(data, back, sizeof(data) - 1) == 0);
+
+	EVE_memWrite_buffer(SCRATCH_ADDR, (const uint8_t *)"123456789", 9, false);
+	CHECK(EVE_cmd_memcrc(SCRATCH_ADDR, 9) == 0xCBF43926UL);	// the CRC-32 check value
+	CHECK(EVE_cmd_regread(REG_HSIZE) == EVE_HSIZE);
+}
+
+
+/* a burst that starts near the end of RAM_CMD is written past it and has to land at its start */
+static void test_fifo_wrap(void)
+{
+	while(cmdOffset < EVE_CMDFIFO_SIZE - 100)
+	{
+		EVE_cmd_dl(CMD_DLSTART);
+	}
+	EVE_cmd_execute();
+
+	uint16_t start = cmdOffset;
+
+	EVE_start_cmd_burst();
+	EVE_cmd_dl(CMD_DLSTART);
+	for(uint32_t i = 0; i < 50; i++)
+	{
+		EVE_cmd_dl(COLOR_RGB(i, 0, 0));
+	}
+	EVE_end_cmd_burst();
+	EVE_cmd_execute();
+
+	CHECK(start + 51 * 4 > EVE_CMDFIFO_SIZE);
+	CHECK(reg(REG_CMD_READ) == cmdOffset);
+	CHECK(reg(REG_CMD_DL) == 50 * 4);
+	CHECK(reg(EVE_RAM_DL + 49 * 4) == COLOR_RGB(49, 0, 0));
+}
+
+
+static void test_inflate(void)
+{
+#if EVE_EMU_ZLIB
+	static uint8_t data[20000];
+	static uint8_t packed[sizeof(data) + 1024];
+	static uint8_t back[sizeof(data)];
+	uLongf packed_len = sizeof(packed);
+
+	for(uint32_t i = 0; i < sizeof(data); i++)
+	{
+		data[i] = (uint8_t)((i / 64) * 7);
+	}
+	CHECK(compress2(packed, &packed_len, data, sizeof(data), 9) == Z_OK);
+
+	EVE_cmd_inflate(SCRATCH_ADDR + 0x10000, packed, packed_len);
+	EVE_cmd_execute();
+
+	eve_emu_read(emu, SCRATCH_ADDR + 0x10000, back, sizeof(back));
+	CHECK(memcmp(data, back, sizeof(data)) == 0);
+	CHECK(EVE_cmd_getptr() == SCRATCH_ADDR + 0x10000 + sizeof(data));
+#else
+	printf("built without zlib, CMD_INFLATE not tested\n");
+#endif
+}
+
+
+static uint32_t noise_state = 1;
+
+static uint16_t noise(void)
+{
+	noise_state = noise_state * 1103515245UL + 12345UL;
+	return (uint16_t)(noise_state >> 16);
+}
+
+
+/* content LittlevGL flushes, RGB565 */
+static void content_flat(uint16_t *px, uint32_t w, uint32_t h)
+{
+	for(uint32_t i = 0; i < w * h; i++)
+	{
+		px[i] = 0x4208;
+	}
+}
+
+
+static void content_lines(uint16_t *px, uint32_t w, uint32_t h)
+{
+	for(uint32_t y = 0; y < h; y++)
+	{
+		for(uint32_t x = 0; x < w; x++)
+		{
+			px[y * w + x] = (uint16_t)(((x * 32) / w) << 11 | ((x * 64) / w) << 5);	// horizontal gradient
+		}
+	}
+}
+
+
+static void content_ui(uint16_t *px, uint32_t w, uint32_t h)
+{
+	for(uint32_t y = 0; y < h; y++)
+	{
+		for(uint32_t x = 0; x < w; x++)
+		{
+			uint16_t c = 0xFFFF;	// background
+
+			if(y >= 40 && y < 160 && x >= 20 && x < 220)
+			{
+				c = (uint16_t)((x - 20) >> 3) | 0x8000;		// panel with a gradient
+			}
+			if((y == 40 || y == 159) && x >= 20 && x < 220)
+			{
+				c = 0x0000;		// its border
+			}
+			if(y >= 60 && y < 156 && x >= 300 && x < 396)
+			{
+				c = noise();	// photo
+			}
+			if(y >= 200 && y < 216 && x >= 20 && x < 460 && ((x / 3 + y) % 5) < 2)
+			{
+				c = 0x001F;		// text like
+			}
+
+			px[y * w + x] = c;
+		}
+	}
+}
+
+
+static void content_noise(uint16_t *px, uint32_t w, uint32_t h)
+{
+	for(uint32_t i = 0; i < w * h; i++)
+	{
+		px[i] = noise();
+	}
+}
+
+
+/* EVE_deflate() streams have to inflate back to the input, also prints what it takes to encode them */
+static void test_deflate(void)
+{
+	static const struct {
+		const char *name;
+		void (*fill)(uint16_t *px, uint32_t w, uint32_t h);
+		uint32_t width;
+		uint32_t height;
+		uint32_t max_percent;	// ratio it has to reach
+	} cases[] = {
+		{"flat", content_flat, EVE_HSIZE, EVE_VSIZE, 2},
+		{"repeated lines", content_lines, EVE_HSIZE, EVE_VSIZE, 5},
+		{"ui screen", content_ui, EVE_HSIZE, EVE_VSIZE, 15},
+		{"noise", content_noise, 128, 96, 115},
+	};
+	static uint16_t pixels[EVE_HSIZE * EVE_VSIZE];
+	static uint8_t packed[sizeof(pixels) + sizeof(pixels) / 4];
+	static uint8_t back[sizeof(pixels)];
+	const uint32_t rounds = 10;
+
+	for(uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		uint32_t len = cases[i].width * cases[i].height * 2;
+		uint32_t deflated = 0;
+
+		cases[i].fill(pixels, cases[i].width, cases[i].height);
+
+		double start = now_us();
+		for(uint32_t j = 0; j < rounds; j++)
+		{
+			deflated = EVE_deflate((const uint8_t *)pixels, len, packed, sizeof(packed));
+		}
+		double us = (now_us() - start) / rounds;
+
+		printf("deflate %-14s %6u -> %6u bytes (%5.1f%%), %7.0f us, %6.1f MB/s\n", cases[i].name, (unsigned)len,
+			(unsigned)deflated, (100.0 * deflated) / len, us, len / us);
+
+		CHECK(deflated > 0 && deflated * 100 <= len * cases[i].max_percent);
+		CHECK(deflated <= 0xFFFC);	// CMD_INFLATE takes a 16 bit length
+
+		// given up on early when bounded as FT81x.c does it
+		if(cases[i].max_percent > 50)
+		{
+			CHECK(EVE_deflate((const uint8_t *)pixels, len, packed, len / 2) == 0);
+		}
+
+#if EVE_EMU_ZLIB
+		// into the screen buffers, test_flush() draws over them
+		EVE_cmd_inflate(0, packed, deflated);
+		EVE_cmd_execute();
+
+		eve_emu_read(emu, 0, back, len);
+		CHECK(memcmp(pixels, back, len) == 0);
+		CHECK(EVE_cmd_getptr() == len);
+#else
+		(void)back;
+#endif
+	}
+
+#if !EVE_EMU_ZLIB
+	printf("built without zlib, EVE_deflate() streams not inflated\n");
+#endif
+}
+
+
+/* an unknown command faults the co-processor, EVE_busy() has to get it going again */
+static void test_fault(void)
+{
+	eve_emu_stats_t stats;
+	uint32_t faults;
+
+	eve_emu_get_stats(emu, &stats);
+	faults = stats.faults;
+
+	EVE_cmd_dl(CMD_LOGO);
+	EVE_cmd_execute();
+
+	eve_emu_get_stats(emu, &stats);
+	CHECK(stats.faults == faults + 1);
+	CHECK(stats.last_unsupported == CMD_LOGO);
+
+	EVE_cmd_memset(SCRATCH_ADDR, 0x3C, 4);
+	EVE_cmd_execute();
+	CHECK(EVE_memRead8(SCRATCH_ADDR + 3) == 0x3C);
+}
+
+
+static void fragment_build(void *user_data)
+{
+	(void)user_data;
+
+	EVE_cmd_dl(COLOR_RGB(0, 0, 255));
+	EVE_cmd_dl(POINT_SIZE(4 * 16));
+	EVE_cmd_dl(DL_BEGIN | EVE_POINTS);
+	EVE_cmd_dl(VERTEX2F(400 * 16, 200 * 16));
+	EVE_cmd_dl(DL_END);
+}
+
+
+/* hand an area to the driver as LittlevGL does, it has to be signalled back exactly once */
+static void flush(const lv_area_t *area, lv_color_t *colors, bool last)
+{
+	lv_disp_drv_t *drv = &_lv_refr_get_disp_refreshing()->driver;
+	uint32_t ready = drv->flush_ready;
+
+	drv->flushing_last = last;
+	FT81x_flush(drv, area, colors);
+
+	CHECK(drv->flush_ready == ready + 1);
+}
+
+
+/* fill the buffer of an area with a pattern, LittlevGL renders an area into a buffer of its own size */
+static void area_fill(lv_color_t *colors, const lv_area_t *area, uint16_t (*pattern)(uint32_t x, uint32_t y))
+{
+	for(lv_coord_t y = area->y1; y <= area->y2; y++)
+	{
+		for(lv_coord_t x = area->x1; x <= area->x2; x++)
+		{
+			colors++->full = pattern(x, y);
+		}
+	}
+}
+
+
+// red following x and green following y
+static uint16_t screen_pattern(uint32_t x, uint32_t y)
+{
+	return ((x & 31) << 11) | ((y & 63) << 5);
+}
+
+
+static uint16_t patch_pattern(uint32_t x, uint32_t y)
+{
+	return (16 << 11) | ((x ^ y) & 31);
+}
+
+
+static bool pixel_is(const uint8_t *rgb, uint32_t width, uint32_t x, uint32_t y, uint16_t rgb565)
+{
+	const uint8_t *pixel = &rgb[(y * width + x) * 3];
+
+	return pixel[0] == ((rgb565 >> 11) * 255) / 31 &&
+		pixel[1] == (((rgb565 >> 5) & 63) * 255) / 63 &&
+		pixel[2] == ((rgb565 & 31) * 255) / 31;
+}
+
+
+/* an area sent raw takes at least its size, a compressed one less than that */
+static void check_frame_bytes(uint32_t area_bytes, uint32_t deflated_before)
+{
+	FT81x_stats_t ft_stats;
+	eve_emu_stats_t stats;
+
+	FT81x_get_stats(&ft_stats);
+	eve_emu_get_stats(emu, &stats);
+
+	if(ft_stats.deflated > deflated_before)
+	{
+		CHECK(stats.frame_bytes < area_bytes);
+	}
+	else
+	{
+		CHECK(stats.frame_bytes >= area_bytes);
+	}
+	CHECK(stats.frame_bytes < area_bytes + 2048);	// the display list and the commands around the upload
+}
+
+
+/* FT81x_flush() of a full frame and then of a partial one, on top of an image layer and a display list fragment */
+static void test_flush(const char *ppm)
+{
+	static lv_color_t colors[EVE_HSIZE * EVE_VSIZE];
+	static uint16_t image[16 * 16];
+	const lv_area_t screen = {0, 0, EVE_HSIZE - 1, EVE_VSIZE - 1};
+	const lv_area_t overlay = {100, 100, 163, 119};
+	const lv_area_t patch = {200, 150, 239, 179};
+	FT81x_stats_t ft_stats;
+	eve_emu_stats_t stats;
+	uint32_t width, height;
+	const uint8_t *rgb;
+
+	// image with a transparent left and a red right half
+	for(uint32_t i = 0; i < 16 * 16; i++)
+	{
+		image[i] = ((i % 16) < 8) ? 0x0000 : 0xFF00;
+	}
+	CHECK(EVE_asset_load(1, EVE_ASSET_RAW, (const uint8_t *)image, sizeof(image), sizeof(image)) != EVE_ASSET_NONE);
+	CHECK(FT81x_image_layer_show(0, 1, EVE_ARGB4, 16, 16, 300, 30));
+	CHECK(FT81x_dl_fragment_set(0, 2, fragment_build, NULL));
+
+	// full frame
+	eve_emu_reset_stats(emu);
+	FT81x_get_stats(&ft_stats);
+	area_fill(colors, &screen, screen_pattern);
+	flush(&screen, colors, true);
+	check_frame_bytes(EVE_HSIZE * EVE_VSIZE * sizeof(lv_color_t), ft_stats.deflated);
+
+	eve_emu_get_stats(emu, &stats);
+	CHECK(stats.frames == 1);
+	printf("full frame: %u SPI bytes, ", (unsigned)stats.frame_bytes);
+
+	rgb = eve_emu_render(emu, &width, &height);
+	CHECK(rgb != NULL && width == EVE_HSIZE && height == EVE_VSIZE);
+	if(rgb == NULL)
+	{
+		printf("\n");
+		return;
+	}
+
+	CHECK(pixel_is(rgb, width, 37, 50, screen_pattern(37, 50)));
+	CHECK(pixel_is(rgb, width, 310, 35, 0xF800));						// image
+	CHECK(pixel_is(rgb, width, 302, 35, screen_pattern(302, 35)));		// its transparent half
+	CHECK(pixel_is(rgb, width, 400, 200, 0x001F));						// fragment
+	CHECK(pixel_is(rgb, width, 400, 210, screen_pattern(400, 210)));
+
+	// partial frame, a solid area and a small one, drawn into the other screen buffer
+	FT81x_get_stats(&ft_stats);
+	for(uint32_t i = 0; i < lv_area_get_size(&overlay); i++)
+	{
+		colors[i].full = 0xFFE0;
+	}
+	flush(&overlay, colors, false);
+	area_fill(colors, &patch, patch_pattern);
+	flush(&patch, colors, true);
+	check_frame_bytes(lv_area_get_size(&patch) * sizeof(lv_color_t), ft_stats.deflated);
+
+	eve_emu_get_stats(emu, &stats);
+	CHECK(stats.frames == 2);
+	CHECK(stats.faults == 0 && stats.unsupported == 0);
+	printf("partial frame: %u SPI bytes\n", (unsigned)stats.frame_bytes);
+
+	rgb = eve_emu_render(emu, &width, &height);
+	CHECK(rgb != NULL);
+	if(rgb == NULL)
+	{
+		return;
+	}
+
+	CHECK(pixel_is(rgb, width, 120, 110, 0xFFE0));						// overlay
+	CHECK(pixel_is(rgb, width, 99, 110, screen_pattern(99, 110)));		// next to it
+	CHECK(pixel_is(rgb, width, 210, 160, patch_pattern(210, 160)));		// area flushed
+	CHECK(pixel_is(rgb, width, 239, 179, patch_pattern(239, 179)));
+	CHECK(pixel_is(rgb, width, 199, 160, screen_pattern(199, 160)));	// copied from the last frame
+	CHECK(pixel_is(rgb, width, 240, 180, screen_pattern(240, 180)));
+	CHECK(pixel_is(rgb, width, 310, 35, 0xF800));						// image, not clipped by the overlay
+	CHECK(pixel_is(rgb, width, 400, 200, 0x001F));						// fragment
+
+	FT81x_get_stats(&ft_stats);
+	CHECK(ft_stats.frames == 2 && ft_stats.flushes == 3 && ft_stats.overlays == 1);
+
+	if(ppm != NULL && !eve_emu_write_ppm(emu, ppm))
+	{
+		fprintf(stderr, "could not write %s\n", ppm);
+		failures++;
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	emu = eve_emu_create();
+	if(emu == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	eve_emu_attach(emu);
+	disp_spi_set_trace_cb(eve_emu_trace_cb);
+	disp_spi_host_set_read_cb(eve_emu_read_cb);
+
+	test_init();
+	test_memory();
+	test_memwrite_chunks();
+	test_dl_build();
+	test_copro_memory();
+	test_fifo_wrap();
+	test_inflate();
+	test_deflate();
+	test_fault();
+	test_flush((argc > 1) ? argv[1] : NULL);
+
+	eve_emu_destroy(emu);
+
+	if(failures > 0)
+	{
+		fprintf(stderr, "%d checks failed\n", failures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file disp_spi_host.c
+ *
+ * disp_spi for host builds of the drivers. Transactions complete as they are sent, they are passed to the
+ * trace callback like on the target and reads are answered by a callback standing in for the display.
+ * Flushes are signalled to the display LVGL refreshes, as the post transaction callback does on the target.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <string.h>
+
+#include "lvgl.h"
+#include "disp_spi.h"
+#include "disp_spi_host.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SPI_DEFAULT_MAX_TRANSFER_SIZE 4092
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static size_t max_transfer_size = 0;
+static uint32_t trans_queued = 0;
+static uint32_t drain_count = 0;
+static disp_spi_stats_t stats;
+static disp_spi_trace_cb_t trace_cb = NULL;
+static disp_spi_host_read_cb_t read_cb = NULL;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void disp_spi_add_device(spi_host_device_t host)
+{
+    (void) host;
+}
+
+void disp_spi_add_device_config(spi_host_device_t host, spi_device_interface_config_t *devcfg)
+{
+    (void) host;
+    (void) devcfg;
+}
+
+void disp_spi_add_device_with_speed(spi_host_device_t host, int clock_speed_hz)
+{
+    (void) host;
+    (void) clock_speed_hz;
+}
+
+void disp_spi_change_device_speed(int clock_speed_hz)
+{
+    (void) clock_speed_hz;
+}
+
+void disp_spi_remove_device()
+{
+}
+
+void disp_spi_transaction(const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint8_t *out,
+    uint64_t addr, uint8_t dummy_bits)
+{
+    if (0 == length) {
+        return;
+    }
+
+    if (trace_cb) {
+        trace_cb(data, length, flags, addr);
+    }
+
+    stats.transactions++;
+    if (flags & DISP_SPI_RECEIVE) {
+        stats.rx_bytes += length;
+    } else {
+        stats.tx_bytes += length;
+    }
+    if (flags & (DISP_SPI_SEND_POLLING | DISP_SPI_SEND_SYNCHRONOUS)) {
+        stats.blocking++;
+    }
+
+    if (!(flags & (DISP_SPI_SEND_POLLING | DISP_SPI_SEND_SYNCHRONOUS))) {
+        trans_queued++;
+    }
+
+    if ((flags & DISP_SPI_RECEIVE) && out != NULL) {
+        /* without dummy bits the first byte is clocked in while the dummy byte is sent */
+        size_t skip = (flags & DISP_SPI_VARIABLE_DUMMY) ? 0 : 1;
+
+        (void) dummy_bits;
+        if (skip) {
+            out[0] = 0;
+        }
+        if (read_cb) {
+            read_cb(addr, out + skip, length - skip);
+        } else {
+            memset(out + skip, 0, length - skip);
+        }
+    }
+
+    if (flags & DISP_SPI_SIGNAL_FLUSH) {
+        lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+        lv_disp_flush_ready(&disp->driver);
+    }
+}
+
+void disp_spi_send_fill(uint8_t pattern, size_t length)
+{
+    uint8_t chunk[64];
+
+    memset(chunk, pattern, sizeof(chunk));
+    while (length > 0) {
+        size_t n = (length > sizeof(chunk)) ? sizeof(chunk) : length;
+        disp_spi_transaction(chunk, n, DISP_SPI_SEND_QUEUED, NULL, 0, 0);
+        length -= n;
+    }
+}
+
+void disp_spi_set_max_transfer_size(size_t size)
+{
+    max_transfer_size = size;
+}
+
+size_t disp_spi_get_max_transfer_size(void)
+{
+    return (max_transfer_size > 0) ? max_transfer_size : SPI_DEFAULT_MAX_TRANSFER_SIZE;
+}
+
+uint32_t disp_spi_get_transaction_seq(void)
+{
+    return trans_queued;
+}
+
+void disp_spi_wait_for_transaction(uint32_t seq)
+{
+    (void) seq;     /* done already */
+}
+
+void disp_spi_set_trace_cb(disp_spi_trace_cb_t cb)
+{
+    trace_cb = cb;
+}
+
+void disp_spi_get_stats(disp_spi_stats_t *stats_out)
+{
+    *stats_out = stats;
+}
+
+void disp_spi_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void disp_wait_for_pending_transactions(void)
+{
+    drain_count++;
+}
+
+void disp_spi_acquire(void)
+{
+}
+
+void disp_spi_release(void)
+{
+}
+
+void disp_spi_host_set_read_cb(disp_spi_host_read_cb_t cb)
+{
+    read_cb = cb;
+}
+
+uint32_t disp_spi_host_get_drain_count(void)
+{
+    return drain_count;
+}
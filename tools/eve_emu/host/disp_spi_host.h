@@ -0,0 +1,44 @@
+/**
+ * @file disp_spi_host.h
+ *
+ */
+
+#ifndef DISP_SPI_HOST_H
+#define DISP_SPI_HOST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stddef.h>
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* Fill data with length bytes read at addr */
+typedef void (*disp_spi_host_read_cb_t)(uint64_t addr, uint8_t *data, size_t length);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/*	The host disp_spi has no bus, every transaction only goes to the trace callback and reads are
+	answered by this callback, zeros without one.
+*/
+void disp_spi_host_set_read_cb(disp_spi_host_read_cb_t cb);
+
+/*	Calls of disp_wait_for_pending_transactions(), each of them would stall the CPU on the target until
+	every queued transaction is clocked out.
+*/
+uint32_t disp_spi_host_get_drain_count(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*DISP_SPI_HOST_H*/
@@ -0,0 +1,90 @@
+/**
+ * @file esp_host.c
+ *
+ * The FreeRTOS, GPIO and partition calls of the EVE driver on the host, where it runs alone in one thread.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "esp_partition.h"
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void vTaskDelay(TickType_t ticks)
+{
+    (void) ticks;   /* the model answers right away, there is nothing to wait for */
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return NULL;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    (void) sem;
+    (void) ticks;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken)
+{
+    (void) sem;
+    (void) woken;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    (void) sem;
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    (void) config;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(int gpio, uint32_t level)
+{
+    (void) gpio;
+    (void) level;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int flags)
+{
+    (void) flags;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(int gpio, void (*handler)(void *), void *arg)
+{
+    (void) gpio;
+    (void) handler;
+    (void) arg;
+    return ESP_OK;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, int subtype, const char *label)
+{
+    (void) type;
+    (void) subtype;
+    (void) label;
+    return NULL;    /* no flash, videos are streamed from a callback */
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    (void) partition;
+    (void) src_offset;
+    (void) dst;
+    (void) size;
+    return ESP_FAIL;
+}
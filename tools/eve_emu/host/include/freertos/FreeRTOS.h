@@ -0,0 +1,25 @@
+/*
+ * Just what the EVE driver uses, it runs in a single thread on the host
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef void *TaskHandle_t;
+typedef void *SemaphoreHandle_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define portMAX_DELAY           0xffffffffu
+#define portTICK_PERIOD_MS      1
+#define portTICK_RATE_MS        1
+#define portYIELD_FROM_ISR()    do {} while(0)
@@ -0,0 +1,75 @@
+/*
+ * The LVGL types and functions the FT81x driver uses, with a display driver the test flushes through by hand
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define LVGL_VERSION_MAJOR 7
+#define LV_COLOR_DEPTH 16
+
+#define LV_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define LV_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+typedef int16_t lv_coord_t;
+typedef uint8_t lv_opa_t;
+typedef struct { lv_coord_t x1, y1, x2, y2; } lv_area_t;
+typedef struct { lv_coord_t x, y; } lv_point_t;
+typedef union { struct { uint16_t blue : 5; uint16_t green : 6; uint16_t red : 5; } ch; uint16_t full; } lv_color_t;
+typedef union { struct { uint8_t blue; uint8_t green; uint8_t red; uint8_t alpha; } ch; uint32_t full; } lv_color32_t;
+typedef struct _lv_indev_drv_t lv_indev_drv_t;
+typedef struct { lv_point_t point; int state; } lv_indev_data_t;
+typedef struct _lv_obj_t lv_obj_t;
+
+typedef struct _lv_disp_drv_t {
+    bool flushing_last;     /* what lv_disp_flush_is_last() returns, set for each area flushed */
+    uint32_t flush_ready;   /* lv_disp_flush_ready() calls */
+} lv_disp_drv_t;
+
+typedef struct {
+    lv_disp_drv_t driver;
+} lv_disp_t;
+
+#define LV_LOG_ERROR(...)   do { fprintf(stderr, "E: " __VA_ARGS__); fputc('\n', stderr); } while(0)
+#define LV_LOG_WARN(...)    do { fprintf(stderr, "W: " __VA_ARGS__); fputc('\n', stderr); } while(0)
+#define LV_LOG_INFO(...)    do {} while(0)
+#define LV_LOG_TRACE(...)   do {} while(0)
+
+static inline lv_coord_t lv_area_get_width(const lv_area_t *area)
+{
+    return (lv_coord_t)(area->x2 - area->x1 + 1);
+}
+
+static inline lv_coord_t lv_area_get_height(const lv_area_t *area)
+{
+    return (lv_coord_t)(area->y2 - area->y1 + 1);
+}
+
+static inline uint32_t lv_area_get_size(const lv_area_t *area)
+{
+    return (uint32_t)lv_area_get_width(area) * (uint32_t)lv_area_get_height(area);
+}
+
+static inline uint32_t lv_color_to32(lv_color_t color)
+{
+    lv_color32_t ret;
+
+    ret.ch.red = (color.ch.red * 263 + 7) >> 5;
+    ret.ch.green = (color.ch.green * 259 + 3) >> 6;
+    ret.ch.blue = (color.ch.blue * 263 + 7) >> 5;
+    ret.ch.alpha = 0xff;
+
+    return ret.full;
+}
+
+bool _lv_area_intersect(lv_area_t *res, const lv_area_t *a1, const lv_area_t *a2);
+bool _lv_area_is_in(const lv_area_t *ain, const lv_area_t *aholder, lv_coord_t radius);
+
+lv_disp_t *_lv_refr_get_disp_refreshing(void);
+void lv_disp_flush_ready(lv_disp_drv_t *disp_drv);
+bool lv_disp_flush_is_last(lv_disp_drv_t *disp_drv);
+
+lv_obj_t *lv_scr_act(void);
+void lv_obj_invalidate(const lv_obj_t *obj);
@@ -0,0 +1,18 @@
+/*
+ * Configuration of the host build, an FT813 based 480x272 display without touch, with the FT81x flush options
+ * that fit in its RAM_G. CONFIG_LV_FT81X_COMPRESSED_UPLOAD is set by CMakeLists.txt when zlib is found.
+ */
+#pragma once
+
+#define CONFIG_LV_TFT_DISPLAY_CONTROLLER_FT81X 1
+#define CONFIG_LV_FT81X_CONFIG_EVE_EVE2_43 1
+#define CONFIG_LV_TOUCH_CONTROLLER_NONE 1
+#define CONFIG_LV_DISPLAY_USE_SPI_CS 1
+#define CONFIG_LV_DISP_SPI_CS 5
+#define CONFIG_LV_DISP_SPI_MOSI 23
+#define CONFIG_LV_DISP_SPI_CLK 18
+#define CONFIG_LV_DISP_PIN_RST 4
+#define CONFIG_LV_FT81X_DOUBLE_BUFFER 1
+#define CONFIG_LV_FT81X_SOLID_FILL_OVERLAY 1
+#define CONFIG_LV_FT81X_ASSET_CACHE 1
+#define CONFIG_LV_FT81X_ASSET_CACHE_SIZE 128
@@ -0,0 +1,61 @@
+/**
+ * @file lvgl_host.c
+ *
+ * The LVGL functions the FT81x driver calls, for a single display flushed by the test itself.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_disp_t disp;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+bool _lv_area_intersect(lv_area_t *res, const lv_area_t *a1, const lv_area_t *a2)
+{
+    res->x1 = LV_MAX(a1->x1, a2->x1);
+    res->y1 = LV_MAX(a1->y1, a2->y1);
+    res->x2 = LV_MIN(a1->x2, a2->x2);
+    res->y2 = LV_MIN(a1->y2, a2->y2);
+
+    return (res->x1 <= res->x2) && (res->y1 <= res->y2);
+}
+
+bool _lv_area_is_in(const lv_area_t *ain, const lv_area_t *aholder, lv_coord_t radius)
+{
+    (void) radius;  /* the driver only asks about rectangles */
+
+    return (ain->x1 >= aholder->x1) && (ain->y1 >= aholder->y1) &&
+           (ain->x2 <= aholder->x2) && (ain->y2 <= aholder->y2);
+}
+
+lv_disp_t *_lv_refr_get_disp_refreshing(void)
+{
+    return &disp;
+}
+
+void lv_disp_flush_ready(lv_disp_drv_t *disp_drv)
+{
+    disp_drv->flush_ready++;
+}
+
+bool lv_disp_flush_is_last(lv_disp_drv_t *disp_drv)
+{
+    return disp_drv->flushing_last;
+}
+
+lv_obj_t *lv_scr_act(void)
+{
+    return NULL;
+}
+
+void lv_obj_invalidate(const lv_obj_t *obj)
+{
+    (void) obj;
+}